@@ -0,0 +1,137 @@
+/* ner: notmuch/bench_thread_grouping.cc
+ *
+ * Copyright (c) 2013 Michael Forney
+ *
+ * This file is a part of ner.
+ *
+ * ner is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License version 3, as published by the Free
+ * Software Foundation.
+ *
+ * ner is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ner.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Compares the time it takes notmuch to build the threads matching a query
+ * with the time it takes to group the matching messages by thread.
+ *
+ * Usage: bench_thread_grouping QUERY...
+ */
+
+#include <iostream>
+#include <chrono>
+
+#include "config.hh"
+#include "database_pool.hh"
+#include "tag_set.hh"
+#include "query.hh"
+#include "thread_grouper.hh"
+
+using namespace Notmuch;
+
+typedef std::chrono::steady_clock Clock;
+
+struct Timing
+{
+    std::chrono::milliseconds first;
+    std::chrono::milliseconds total;
+    size_t threads;
+};
+
+static std::chrono::milliseconds since(Clock::time_point start)
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start);
+}
+
+static Timing time_threads(const std::string & terms)
+{
+    auto database = DatabasePool::instance().reader();
+    StringPool pool;
+    Timing timing = { std::chrono::milliseconds(0), std::chrono::milliseconds(0), 0 };
+
+    auto start = Clock::now();
+
+    Query query(terms, database.get());
+    query.set_sort_mode(SortMode::NewestFirst);
+
+    for (const auto & thread : query.thread_summaries(pool))
+    {
+        (void) thread;
+
+        if (timing.threads++ == 0)
+            timing.first = since(start);
+    }
+
+    timing.total = since(start);
+
+    return timing;
+}
+
+static Timing time_messages(const std::string & terms)
+{
+    auto database = DatabasePool::instance().reader();
+    StringPool pool;
+    Timing timing = { std::chrono::milliseconds(0), std::chrono::milliseconds(0), 0 };
+
+    auto start = Clock::now();
+
+    Query query(terms, database.get());
+    query.set_sort_mode(SortMode::NewestFirst);
+
+    ThreadGrouper grouper(pool);
+    grouper.group(query, [&](size_t index, bool added) {
+        if (added && index == 0)
+            timing.first = since(start);
+
+        return true;
+    });
+
+    timing.total = since(start);
+    timing.threads = grouper.size();
+
+    return timing;
+}
+
+static void print(const std::string & engine, const Timing & timing)
+{
+    std::cout << "  " << engine << ": " << timing.threads << " threads, first after "
+        << timing.first.count() << " ms, all after " << timing.total.count() << " ms"
+        << std::endl;
+}
+
+int main(int argc, char * argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " QUERY..." << std::endl;
+        return 1;
+    }
+
+    Config config;
+    config.load();
+
+    DatabasePool database_pool;
+    TagDictionary tag_dictionary;
+
+    for (int index = 1; index < argc; ++index)
+    {
+        std::cout << argv[index] << std::endl;
+
+        /* Run each engine once first, so that both run with a warm cache. */
+        time_threads(argv[index]);
+        print("threads", time_threads(argv[index]));
+
+        time_messages(argv[index]);
+        print("messages", time_messages(argv[index]));
+    }
+
+    return 0;
+}
+
+// vim: fdm=syntax fo=croql et sw=4 sts=4 ts=8
+
@@ -0,0 +1,268 @@
+/* ner: notmuch/count_cache.cc
+ *
+ * Copyright (c) 2013 Michael Forney
+ *
+ * This file is a part of ner.
+ *
+ * ner is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License version 3, as published by the Free
+ * Software Foundation.
+ *
+ * ner is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ner.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <memory>
+#include <cstdlib>
+#include <cstdio>
+#include <stdexcept>
+#include <sys/stat.h>
+
+#include "count_cache.hh"
+#include "database_pool.hh"
+#include "query.hh"
+
+namespace Notmuch
+{
+    static std::string cache_directory()
+    {
+        const char * cache_home = std::getenv("XDG_CACHE_HOME");
+
+        if (cache_home && *cache_home)
+            return std::string(cache_home) + "/ner";
+
+        const char * home = std::getenv("HOME");
+
+        return std::string(home ? home : ".") + "/.cache/ner";
+    }
+
+    CountCache * CountCache::_instance = nullptr;
+
+    CountCache & CountCache::instance()
+    {
+        return *_instance;
+    }
+
+    CountCache::CountCache(unsigned workers)
+        : _path(cache_directory() + "/counts"), _changed(false), _stopping(false)
+    {
+        _instance = this;
+
+        load();
+
+        for (unsigned index = 0; index < workers; ++index)
+            _workers.push_back(std::thread(std::bind(&CountCache::run, this)));
+    }
+
+    CountCache::~CountCache()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stopping = true;
+        }
+
+        _condition.notify_all();
+
+        for (auto & worker : _workers)
+            worker.join();
+
+        _instance = nullptr;
+    }
+
+    bool CountCache::counts(const std::string & terms, Counts & counts) const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        auto entry = _entries.find(terms);
+
+        if (entry == _entries.end())
+            return false;
+
+        counts = entry->second.counts;
+        return true;
+    }
+
+    void CountCache::refresh(const std::vector<std::string> & terms)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+
+            for (auto & query : terms)
+            {
+                if (std::find(_pending.begin(), _pending.end(), query) == _pending.end()
+                    && std::find(_counting.begin(), _counting.end(), query) == _counting.end())
+                {
+                    _pending.push_back(query);
+                }
+            }
+        }
+
+        _condition.notify_all();
+    }
+
+    void CountCache::set_change_listener(const std::function<void ()> & listener)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _change_listener = listener;
+    }
+
+    void CountCache::run()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+
+        while (true)
+        {
+            _condition.wait(lock, [this]() { return !_pending.empty() || _stopping; });
+
+            if (_stopping)
+                break;
+
+            lock.unlock();
+
+            /* Keep the connection for as long as there is work, so that each
+             * worker ends up with its own. */
+            std::unique_ptr<DatabasePool::Lease> database;
+
+            try
+            {
+                database.reset(new DatabasePool::Lease(DatabasePool::instance().reader()));
+            }
+            catch (const std::runtime_error & e)
+            {
+                /* The database could not be opened; try again with the next
+                 * refresh. */
+                lock.lock();
+                _pending.clear();
+                continue;
+            }
+
+            std::string uuid;
+            unsigned long revision = (*database)->revision(uuid);
+
+            lock.lock();
+
+            /* Counts from a different database can't be compared by
+             * revision. */
+            if (uuid != _uuid)
+            {
+                _entries.clear();
+                _uuid = uuid;
+            }
+
+            while (!_pending.empty() && !_stopping)
+            {
+                std::string terms = std::move(_pending.front());
+                _pending.pop_front();
+
+                auto entry = _entries.find(terms);
+
+                if (entry != _entries.end() && entry->second.revision == revision)
+                    continue;
+
+                _counting.push_back(terms);
+                lock.unlock();
+
+                Counts counts;
+                counts.total = Query(terms, database->get()).count_messages();
+                counts.unread = counts.total == 0 ? 0
+                    : Query("(" + terms + ") and tag:unread", database->get()).count_messages();
+
+                lock.lock();
+                _counting.erase(std::find(_counting.begin(), _counting.end(), terms));
+
+                auto stored = _entries.find(terms);
+                bool different = stored == _entries.end()
+                    || stored->second.counts.total != counts.total
+                    || stored->second.counts.unread != counts.unread;
+
+                _entries[terms] = Entry{ revision, counts };
+                _changed = true;
+
+                if (different && _change_listener)
+                    _change_listener();
+            }
+
+            /* Save once every worker is done, rather than after each query. */
+            bool save_counts = _changed && _counting.empty() && _pending.empty();
+
+            if (save_counts)
+                _changed = false;
+
+            lock.unlock();
+            database.reset();
+
+            if (save_counts)
+                save();
+
+            lock.lock();
+        }
+    }
+
+    void CountCache::load()
+    {
+        std::ifstream file(_path);
+        std::string line;
+
+        if (!std::getline(file, _uuid))
+            return;
+
+        while (std::getline(file, line))
+        {
+            std::istringstream stream(line);
+            Entry entry;
+            std::string terms;
+
+            if (stream >> entry.revision >> entry.counts.total >> entry.counts.unread
+                && stream.get() == ' '
+                && std::getline(stream, terms))
+            {
+                _entries[terms] = entry;
+            }
+        }
+    }
+
+    void CountCache::save() const
+    {
+        std::string directory = cache_directory();
+        std::string temporary = _path + ".tmp";
+
+        /* The cache directory may not exist yet. */
+        mkdir(directory.substr(0, directory.rfind('/')).c_str(), 0700);
+        mkdir(directory.c_str(), 0700);
+
+        {
+            std::ofstream file(temporary);
+
+            std::lock_guard<std::mutex> lock(_mutex);
+
+            file << _uuid << '\n';
+
+            for (auto & entry : _entries)
+            {
+                /* Queries are written last, since they contain spaces, and
+                 * can't contain newlines. */
+                if (entry.first.find('\n') == std::string::npos)
+                {
+                    file << entry.second.revision << ' ' << entry.second.counts.total
+                        << ' ' << entry.second.counts.unread << ' ' << entry.first << '\n';
+                }
+            }
+
+            if (!file)
+                return;
+        }
+
+        std::rename(temporary.c_str(), _path.c_str());
+    }
+}
+
+// vim: fdm=syntax fo=croql et sw=4 sts=4 ts=8
+
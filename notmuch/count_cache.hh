@@ -0,0 +1,118 @@
+/* ner: notmuch/count_cache.hh
+ *
+ * Copyright (c) 2013 Michael Forney
+ *
+ * This file is a part of ner.
+ *
+ * ner is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License version 3, as published by the Free
+ * Software Foundation.
+ *
+ * ner is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ner.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NER_NOTMUCH_COUNT_CACHE_H
+#define NER_NOTMUCH_COUNT_CACHE_H 1
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace Notmuch
+{
+    /**
+     * Remembers the number of messages matching queries.
+     *
+     * Each count is stored along with the database revision it was counted
+     * at, and is only counted again once the revision changes. Counting is
+     * done by a few worker threads, each with its own database connection,
+     * so the last known count can be shown in the meantime.
+     *
+     * The counts are saved to $XDG_CACHE_HOME/ner/counts, so that they are
+     * available as soon as ner starts.
+     *
+     * This class is a singleton.
+     */
+    class CountCache
+    {
+        public:
+            static CountCache & instance();
+
+            struct Counts
+            {
+                unsigned total;
+                unsigned unread;
+            };
+
+            /**
+             * \param workers The number of queries to count at the same time.
+             */
+            CountCache(unsigned workers = 3);
+            ~CountCache();
+
+            /**
+             * Looks up the last known number of messages matching the query,
+             * and how many of them are unread.
+             *
+             * \return Whether the query has been counted before.
+             */
+            bool counts(const std::string & terms, Counts & counts) const;
+
+            /**
+             * Counts the queries again in the background if the database
+             * changed since they were last counted.
+             */
+            void refresh(const std::vector<std::string> & terms);
+
+            /**
+             * Sets a function to call whenever a count changes. It is called
+             * from a worker thread.
+             */
+            void set_change_listener(const std::function<void ()> & listener);
+
+        private:
+            struct Entry
+            {
+                unsigned long revision;
+                Counts counts;
+            };
+
+            void run();
+
+            void load();
+            void save() const;
+
+            static CountCache * _instance;
+
+            mutable std::mutex _mutex;
+            std::condition_variable _condition;
+            std::vector<std::thread> _workers;
+
+            std::map<std::string, Entry> _entries;
+            std::deque<std::string> _pending;
+            std::vector<std::string> _counting;
+            std::string _uuid;
+            std::string _path;
+
+            std::function<void ()> _change_listener;
+
+            bool _changed;
+            bool _stopping;
+    };
+}
+
+#endif
+
+// vim: fdm=syntax fo=croql et sw=4 sts=4 ts=8
+
@@ -24,33 +24,32 @@
 #include "exception.hh"
 #include "query.hh"
 
+/* notmuch_database_reopen was added in libnotmuch 5.4 (notmuch 0.32). */
+#if defined LIBNOTMUCH_CHECK_VERSION
+#   if LIBNOTMUCH_CHECK_VERSION(5, 4, 0)
+#       define HAVE_NOTMUCH_DATABASE_REOPEN 1
+#   endif
+#endif
+
 namespace Notmuch
 {
-    Database::Database(Mode mode)
+    static notmuch_database_mode_t notmuch_mode(Database::Mode mode)
     {
-        notmuch_database_mode_t notmuch_mode;
-
         switch (mode)
         {
-            case Mode::ReadOnly:
-                notmuch_mode = NOTMUCH_DATABASE_MODE_READ_ONLY;
-                break;
-            case Mode::ReadWrite:
-                notmuch_mode = NOTMUCH_DATABASE_MODE_READ_WRITE;
-                break;
+            case Database::Mode::ReadOnly:
+                return NOTMUCH_DATABASE_MODE_READ_ONLY;
+            case Database::Mode::ReadWrite:
+                return NOTMUCH_DATABASE_MODE_READ_WRITE;
             default:
                 throw std::invalid_argument("Invalid mode");
         }
+    }
 
-        notmuch_database_t * notmuch_database;
-
-        notmuch_status_t status = notmuch_database_open(
-            Config::instance().database.path.c_str(), notmuch_mode, &notmuch_database);
-
-        _database = ptr(notmuch_database);
-
-        if (status != NOTMUCH_STATUS_SUCCESS)
-            throw std::runtime_error("Could not open database");
+    Database::Database(Mode mode)
+        : _mode(mode)
+    {
+        open();
     }
 
     Database::~Database()
@@ -62,6 +61,41 @@ namespace Notmuch
         _database.reset();
     }
 
+    void Database::reopen()
+    {
+#if HAVE_NOTMUCH_DATABASE_REOPEN
+        if (_database)
+        {
+            if (notmuch_database_reopen(_database.get(), notmuch_mode(_mode))
+                != NOTMUCH_STATUS_SUCCESS)
+            {
+                throw std::runtime_error("Could not reopen database");
+            }
+
+            return;
+        }
+#endif
+
+        close();
+        open();
+    }
+
+    Database::Mode Database::mode() const
+    {
+        return _mode;
+    }
+
+    unsigned long Database::revision(std::string & uuid) const
+    {
+        const char * notmuch_uuid;
+        unsigned long revision = notmuch_database_get_revision(_database.get(),
+            &notmuch_uuid);
+
+        uuid = notmuch_uuid;
+
+        return revision;
+    }
+
     Message Database::find_message(const std::string & id, Message::Parts parts)
     {
         notmuch_message_t * message;
@@ -86,10 +120,49 @@ namespace Notmuch
         return *thread;
     }
 
+    void Database::open()
+    {
+        notmuch_database_t * notmuch_database;
+
+        notmuch_status_t status = notmuch_database_open(
+            Config::instance().database.path.c_str(), notmuch_mode(_mode),
+            &notmuch_database);
+
+        _database = ptr(notmuch_database);
+
+        if (status != NOTMUCH_STATUS_SUCCESS)
+            throw std::runtime_error("Could not open database");
+    }
+
     notmuch_database_t * Database::get() const
     {
         return _database.get();
     }
+
+    Transaction::Transaction(const Database * database)
+        : _database(database), _open(false)
+    {
+        if (notmuch_database_begin_atomic(_database->get()) != NOTMUCH_STATUS_SUCCESS)
+            throw std::runtime_error("Could not begin transaction");
+
+        _open = true;
+    }
+
+    Transaction::~Transaction()
+    {
+        /* notmuch can't abort a transaction, but one left open would keep
+         * any later changes on the connection from being committed. */
+        if (_open)
+            notmuch_database_end_atomic(_database->get());
+    }
+
+    void Transaction::commit()
+    {
+        _open = false;
+
+        if (notmuch_database_end_atomic(_database->get()) != NOTMUCH_STATUS_SUCCESS)
+            throw std::runtime_error("Could not commit transaction");
+    }
 }
 
 // vim: fdm=syntax fo=croql et sw=4 sts=4 ts=8
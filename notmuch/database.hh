@@ -46,16 +46,59 @@ namespace Notmuch
 
             void close();
 
+            /**
+             * Reopen the database connection so that changes made since it
+             * was opened become visible.
+             */
+            void reopen();
+
+            Mode mode() const;
+
+            /**
+             * Returns the revision of the database, which increases with every
+             * committed change.
+             *
+             * \param uuid Set to the UUID of the database. Revisions are only
+             *             comparable between connections with the same UUID.
+             */
+            unsigned long revision(std::string & uuid) const;
+
             Message find_message(const std::string & id, Message::Parts parts = Message::AllParts);
             Thread find_thread(const std::string & id, Thread::Parts parts = Thread::AllParts);
 
         private:
+            void open();
+
             notmuch_database_t * get() const;
 
+            Mode _mode;
             Pointer<notmuch_database_t> _database;
 
         friend class Query;
         friend class Message;
+        friend class TagDictionary;
+        friend class Transaction;
+    };
+
+    /**
+     * Groups the changes made to a database while it exists into a single
+     * atomic transaction, which is ended even if an exception is thrown.
+     */
+    class Transaction
+    {
+        public:
+            Transaction(const Database * database);
+            Transaction(const Transaction & other) = delete;
+            ~Transaction();
+
+            /**
+             * Ends the transaction, committing the changes made in it.
+             */
+            void commit();
+
+        private:
+            const Database * _database;
+            bool _open;
     };
 }
 
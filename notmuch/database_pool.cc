@@ -0,0 +1,158 @@
+/* ner: notmuch/database_pool.cc
+ *
+ * Copyright (c) 2013 Michael Forney
+ *
+ * This file is a part of ner.
+ *
+ * ner is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License version 3, as published by the Free
+ * Software Foundation.
+ *
+ * ner is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ner.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <sys/stat.h>
+
+#include "config.hh"
+#include "database_pool.hh"
+
+namespace Notmuch
+{
+    DatabasePool * DatabasePool::_instance = nullptr;
+
+    DatabasePool::Lease::Lease(DatabasePool * pool, std::unique_ptr<Database> database,
+        unsigned generation)
+        : _pool(pool), _database(std::move(database)), _generation(generation)
+    {
+    }
+
+    DatabasePool::Lease::Lease(Lease && other)
+        : _pool(other._pool), _database(std::move(other._database)),
+            _generation(other._generation)
+    {
+    }
+
+    DatabasePool::Lease::~Lease()
+    {
+        if (_database)
+            _pool->release(*this);
+    }
+
+    DatabasePool & DatabasePool::instance()
+    {
+        return *_instance;
+    }
+
+    DatabasePool::DatabasePool(unsigned max_idle)
+        : _max_idle(max_idle), _generation(0),
+            _xapian_path(Config::instance().database.path + "/.notmuch/xapian"),
+            _xapian_mtime(0)
+    {
+        _instance = this;
+
+        check_for_changes();
+    }
+
+    DatabasePool::~DatabasePool()
+    {
+        _instance = nullptr;
+    }
+
+    DatabasePool::Lease DatabasePool::reader()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+
+        check_for_changes();
+
+        if (_idle.empty())
+        {
+            unsigned generation = _generation;
+            lock.unlock();
+
+            std::unique_ptr<Database> database(new Database(Database::Mode::ReadOnly));
+            return Lease(this, std::move(database), generation);
+        }
+
+        /* Prefer the connection this thread used last, so that a thread keeps
+         * its own connection as long as it is idle. */
+        auto idle = std::find_if(_idle.rbegin(), _idle.rend(), [](const Idle & entry) {
+            return entry.owner == std::this_thread::get_id();
+        });
+
+        if (idle == _idle.rend())
+            idle = _idle.rbegin();
+
+        std::unique_ptr<Database> database(std::move(idle->database));
+        bool stale = idle->generation != _generation;
+        unsigned generation = _generation;
+
+        _idle.erase(std::next(idle).base());
+        lock.unlock();
+
+        if (stale)
+            database->reopen();
+
+        return Lease(this, std::move(database), generation);
+    }
+
+    DatabasePool::Lease DatabasePool::writer()
+    {
+        std::unique_ptr<Database> database(new Database(Database::Mode::ReadWrite));
+        return Lease(this, std::move(database), 0);
+    }
+
+    void DatabasePool::changed()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        ++_generation;
+    }
+
+    void DatabasePool::release(Lease & lease)
+    {
+        if (lease._database->mode() == Database::Mode::ReadWrite)
+        {
+            /* Close the connection first so that the changes are committed
+             * before anyone reopens. */
+            lease._database.reset();
+            changed();
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        if (_idle.size() >= _max_idle)
+        {
+            /* Drop the least recently used connection. */
+            _idle.erase(_idle.begin());
+        }
+
+        _idle.push_back({ std::move(lease._database), std::this_thread::get_id(),
+            lease._generation });
+    }
+
+    void DatabasePool::check_for_changes()
+    {
+        /* Xapian replaces its version file whenever it commits a transaction,
+         * which updates the modification time of the directory. This catches
+         * changes made by other processes, such as notmuch new. */
+        struct stat info;
+
+        if (stat(_xapian_path.c_str(), &info) == 0 && info.st_mtime != _xapian_mtime)
+        {
+            if (_xapian_mtime != 0)
+                ++_generation;
+
+            _xapian_mtime = info.st_mtime;
+        }
+    }
+}
+
+// vim: fdm=syntax fo=croql et sw=4 sts=4 ts=8
+
@@ -0,0 +1,127 @@
+/* ner: notmuch/database_pool.hh
+ *
+ * Copyright (c) 2013 Michael Forney
+ *
+ * This file is a part of ner.
+ *
+ * ner is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License version 3, as published by the Free
+ * Software Foundation.
+ *
+ * ner is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ner.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NER_NOTMUCH_DATABASE_POOL_H
+#define NER_NOTMUCH_DATABASE_POOL_H 1
+
+#include <memory>
+#include <string>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <ctime>
+
+#include "notmuch/database.hh"
+
+namespace Notmuch
+{
+    /**
+     * Keeps database connections open between operations.
+     *
+     * Read-only connections are leased to one thread at a time and returned
+     * to the pool when the lease ends, so the UI thread keeps reusing the
+     * same connection and background threads each get their own. Idle
+     * connections are reopened before they are handed out again if the
+     * database changed in the meantime.
+     *
+     * Read-write connections are never pooled; they are opened for a single
+     * batch of writes, since holding one blocks every other writer.
+     *
+     * This class is a singleton.
+     */
+    class DatabasePool
+    {
+        public:
+            class Lease
+            {
+                public:
+                    Lease(Lease && other);
+                    Lease(const Lease & other) = delete;
+                    ~Lease();
+
+                    Database * get() const { return _database.get(); }
+                    Database * operator->() const { return _database.get(); }
+                    Database & operator*() const { return *_database; }
+
+                private:
+                    Lease(DatabasePool * pool, std::unique_ptr<Database> database,
+                        unsigned generation);
+
+                    DatabasePool * _pool;
+                    std::unique_ptr<Database> _database;
+                    unsigned _generation;
+
+                friend class DatabasePool;
+            };
+
+            static DatabasePool & instance();
+
+            /**
+             * \param max_idle The maximum number of idle read-only connections
+             *                 to keep open.
+             */
+            DatabasePool(unsigned max_idle = 4);
+            ~DatabasePool();
+
+            /**
+             * Lease a read-only connection for the calling thread.
+             */
+            Lease reader();
+
+            /**
+             * Open a read-write connection for a batch of writes.
+             *
+             * When the lease ends, the connection is closed and the pooled
+             * read-only connections are marked out of date.
+             */
+            Lease writer();
+
+            /**
+             * Mark the pooled read-only connections out of date, so that they
+             * are reopened before their next use.
+             */
+            void changed();
+
+        private:
+            struct Idle
+            {
+                std::unique_ptr<Database> database;
+                std::thread::id owner;
+                unsigned generation;
+            };
+
+            void release(Lease & lease);
+            void check_for_changes();
+
+            static DatabasePool * _instance;
+
+            std::mutex _mutex;
+            std::vector<Idle> _idle;
+            unsigned _max_idle;
+            unsigned _generation;
+
+            std::string _xapian_path;
+            time_t _xapian_mtime;
+    };
+}
+
+#endif
+
+// vim: fdm=syntax fo=croql et sw=4 sts=4 ts=8
+
@@ -18,6 +18,9 @@
  */
 
 #include "iterator.hh"
+#include "message.hh"
+#include "thread.hh"
+#include "thread_summary.hh"
 
 namespace Notmuch
 {
@@ -31,6 +34,7 @@ namespace Notmuch
 
     DEFINE_ITERATOR_FUNCTIONS(MessageIterator, messages);
     DEFINE_ITERATOR_FUNCTIONS(ThreadIterator, threads);
+    DEFINE_ITERATOR_FUNCTIONS(ThreadSummaryIterator, threads);
     DEFINE_ITERATOR_FUNCTIONS(TagIterator, tags);
 }
 
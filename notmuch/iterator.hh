@@ -29,6 +29,7 @@ namespace Notmuch
 {
     class Message;
     class Thread;
+    struct ThreadSummary;
 
     template <typename Collection>
     struct CollectionTraits;
@@ -51,17 +52,38 @@ namespace Notmuch
         typedef const char * Value;
     };
 
+    /**
+     * The type describing which parts of an object to load.
+     */
+    template <typename Type>
+    struct ObjectTraits
+    {
+        typedef typename Type::Parts Parts;
+    };
+
+    template<>
+    struct ObjectTraits<const char *>
+    {
+        typedef unsigned int Parts;
+    };
+
     template <typename Type, typename Collection>
     class Iterator : public std::iterator<std::input_iterator_tag, Type>
     {
         public:
-            explicit Iterator(Collection * collection)
-                : _collection(collection)
+            typedef typename ObjectTraits<Type>::Parts Parts;
+
+            /**
+             * Creates an iterator over the collection which only loads the
+             * given parts of each object.
+             */
+            explicit Iterator(Collection * collection, Parts parts = ~0)
+                : _collection(collection), _parts(parts)
             {
             }
 
             Iterator()
-                : _collection(NULL)
+                : _collection(NULL), _parts(0)
             {
             }
 
@@ -69,7 +91,7 @@ namespace Notmuch
             {
                 assert(valid(_collection));
                 auto object = ptr(get(_collection));
-                return Type(object.get());
+                return Type(object.get(), _parts);
             }
 
             const Iterator & operator++() const
@@ -99,10 +121,12 @@ namespace Notmuch
             static const MoveToNextFunction move_to_next;
 
             Collection * _collection;
+            Parts _parts;
     };
 
     typedef Iterator<Message, notmuch_messages_t> MessageIterator;
     typedef Iterator<Thread, notmuch_threads_t> ThreadIterator;
+    typedef Iterator<ThreadSummary, notmuch_threads_t> ThreadSummaryIterator;
     typedef Iterator<const char *, notmuch_tags_t> TagIterator;
 }
 
@@ -18,7 +18,8 @@
  */
 
 #include "message.hh"
-#include "database.hh"
+#include "tag_queue.hh"
+#include "query.hh"
 
 namespace Notmuch
 {
@@ -30,78 +31,34 @@ namespace Notmuch
             subject = notmuch_message_get_header(message, "subject");
             date = std::chrono::system_clock::from_time_t(
                 notmuch_message_get_date(message));
+        }
 
-            headers.insert(std::make_pair("from",
-                notmuch_message_get_header(message, "from") ?: "(null)"));
-
+        if (parts & TagsPart)
+        {
+            auto & dictionary = TagDictionary::instance();
             notmuch_tags_t * notmuch_tags;
             for (notmuch_tags = notmuch_message_get_tags(message);
                 notmuch_tags_valid(notmuch_tags);
                 notmuch_tags_move_to_next(notmuch_tags))
             {
-                tags.insert(notmuch_tags_get(notmuch_tags));
+                tags.insert(dictionary.id(notmuch_tags_get(notmuch_tags)));
             }
         }
 
+        if (parts & HeadersPart)
+        {
+            headers.insert(std::make_pair("from",
+                notmuch_message_get_header(message, "from") ?: "(null)"));
+        }
+
         if (parts & FilenamePart)
             filename = notmuch_message_get_filename(message);
     }
 
-    bool Message::perform_tag_operations(const TagOperations & ops)
+    void Message::perform_tag_operations(const TagOperations & ops)
     {
-        Database database(Database::Mode::ReadWrite);
-
-        notmuch_message_t * message;
-        notmuch_status_t status;
-
-        status = notmuch_database_find_message(database.get(),
-            id.c_str(), &message);
-        if (status != NOTMUCH_STATUS_SUCCESS)
-            return false;
-
-        if ((status = notmuch_message_freeze(message)) != NOTMUCH_STATUS_SUCCESS)
-            return false;
-
-        for (auto & op : ops)
-        {
-            switch (op.type)
-            {
-                case TagOperation::Add:
-                    notmuch_message_add_tag(message, op.tag.c_str());
-                    break;
-                case TagOperation::Remove:
-                    notmuch_message_remove_tag(message, op.tag.c_str());
-                    break;
-                case TagOperation::Clear:
-                    notmuch_message_remove_all_tags(message);
-                    break;
-            }
-        }
-
-        if ((status = notmuch_message_thaw(message)) != NOTMUCH_STATUS_SUCCESS)
-            return false;
-
-        database.close();
-
-        /* Now that the tag operations have been applied, we can apply these
-         * operations to our message structure. */
-        for (auto & op : ops)
-        {
-            switch (op.type)
-            {
-                case TagOperation::Add:
-                    tags.insert(op.tag);
-                    break;
-                case TagOperation::Remove:
-                    tags.erase(tags.find(op.tag));
-                    break;
-                case TagOperation::Clear:
-                    tags.clear();
-                    break;
-            }
-        }
-
-        return true;
+        apply_tag_operations(tags, ops);
+        TagQueue::instance().enqueue(id_term(id), ops);
     }
 }
 
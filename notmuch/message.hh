@@ -22,13 +22,12 @@
 
 #include <chrono>
 #include <map>
-#include <set>
 #include <string>
 #include <notmuch.h>
 
+#include "notmuch/iterator.hh"
 #include "notmuch/tag_operations.hh"
 #include "notmuch/util.hh"
-#include "notmuch/tree.hh"
 
 namespace Notmuch
 {
@@ -37,8 +36,10 @@ namespace Notmuch
         public:
             enum
             {
-                MetadataPart = 1 << 0,
-                FilenamePart = 1 << 1
+                MetadataPart    = 1 << 0,
+                TagsPart        = 1 << 1,
+                HeadersPart     = 1 << 2,
+                FilenamePart    = 1 << 3
             };
 
             typedef unsigned int Parts;
@@ -46,21 +47,40 @@ namespace Notmuch
 
             Message() = default;
 
+            /* Metadata */
             std::string id;
             std::string subject;
             std::chrono::system_clock::time_point date;
-            std::set<std::string> tags;
+
+            /* Tags */
+            TagSet tags;
+
+            /* Filename */
             std::string filename;
 
+            /* Headers
+             *
+             * Only the headers notmuch keeps in its database are loaded, so
+             * that this does not require reading the message file. */
             std::map<CaseInsensitiveString, std::string> headers;
 
-            bool perform_tag_operations(const TagOperations & ops);
+            /**
+             * Applies the tag operations to the message's tags, and queues
+             * them to be written to the database.
+             */
+            void perform_tag_operations(const TagOperations & ops);
 
         private:
             Message(notmuch_message_t * message, Parts parts = AllParts);
 
         friend class Database;
-        friend void build_message_tree(Tree<Message> & tree, notmuch_messages_t * messages);
+        friend class MessageTree;
+
+#if defined __GNUC__ && !__GNUC_PREREQ(4, 7)
+        friend class Iterator<Message, notmuch_messages_t>;
+#else
+        friend MessageIterator;
+#endif
     };
 }
 
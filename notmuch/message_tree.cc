@@ -21,14 +21,37 @@
 
 namespace Notmuch
 {
-    void build_message_tree(Tree<Message> & tree, notmuch_messages_t * messages)
+    MessageTree::MessageTree(notmuch_messages_t * messages, Message::Parts parts)
     {
-        for (; notmuch_messages_valid(messages); notmuch_messages_move_to_next(messages))
+        /* The replies still to be visited at each level, along with the index
+         * of the message they reply to. Deep threads would overflow the call
+         * stack if this were done recursively. */
+        std::vector<std::pair<notmuch_messages_t *, uint32_t>> levels;
+        levels.push_back(std::make_pair(messages, NoParent));
+
+        while (!levels.empty())
         {
-            notmuch_message_t * message = notmuch_messages_get(messages);
-            tree.children.push_back({ Message(message), Tree<Message>() });
-            build_message_tree(tree.children.back().branch,
-                notmuch_message_get_replies(message));
+            notmuch_messages_t * replies = levels.back().first;
+            uint32_t parent = levels.back().second;
+
+            if (!notmuch_messages_valid(replies))
+            {
+                /* All of the parent's descendants have been added. */
+                if (parent != NoParent)
+                    _nodes[parent].subtree_size = _nodes.size() - parent;
+
+                levels.pop_back();
+                continue;
+            }
+
+            notmuch_message_t * message = notmuch_messages_get(replies);
+            notmuch_messages_move_to_next(replies);
+
+            uint32_t index = _nodes.size();
+            _nodes.push_back({ Message(message, parts), parent, 1,
+                uint32_t(levels.size() - 1), !notmuch_messages_valid(replies) });
+
+            levels.push_back(std::make_pair(notmuch_message_get_replies(message), index));
         }
     }
 }
@@ -21,14 +21,71 @@
 #define NER_NOTMUCH_MESSAGE_TREE_H 1
 
 #include <vector>
+#include <cstdint>
 #include <notmuch.h>
 
 #include "notmuch/message.hh"
-#include "notmuch/tree.hh"
 
 namespace Notmuch
 {
-    void build_message_tree(Tree<Message> & tree, notmuch_messages_t * messages);
+    /**
+     * The messages of a thread and their replies, stored in preorder.
+     *
+     * Each node records its position in the tree, so that a message can be
+     * found by its index, and the tree can be drawn starting at any node,
+     * without walking the tree from its root.
+     */
+    class MessageTree
+    {
+        public:
+            struct Node
+            {
+                Message message;
+
+                /* The index of the parent node, or NoParent for top-level
+                 * messages. */
+                uint32_t parent;
+
+                /* The number of nodes in the subtree rooted at this node,
+                 * including itself. */
+                uint32_t subtree_size;
+
+                /* The number of ancestors. */
+                uint32_t depth;
+
+                /* Whether this is the last reply to its parent. */
+                bool last;
+            };
+
+            static const uint32_t NoParent = ~0u;
+
+            typedef std::vector<Node>::iterator iterator;
+            typedef std::vector<Node>::const_iterator const_iterator;
+
+            MessageTree() = default;
+
+            size_t size() const { return _nodes.size(); }
+            bool empty() const { return _nodes.empty(); }
+
+            Node & operator[](size_t index) { return _nodes[index]; }
+            const Node & operator[](size_t index) const { return _nodes[index]; }
+
+            iterator begin() { return _nodes.begin(); }
+            iterator end() { return _nodes.end(); }
+            const_iterator begin() const { return _nodes.begin(); }
+            const_iterator end() const { return _nodes.end(); }
+
+        private:
+            /**
+             * Builds a tree of the given messages and their replies, loading
+             * only the requested parts of each message.
+             */
+            MessageTree(notmuch_messages_t * messages, Message::Parts parts);
+
+            std::vector<Node> _nodes;
+
+        friend class Thread;
+    };
 }
 
 #endif
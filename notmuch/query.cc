@@ -18,13 +18,58 @@
  */
 
 #include <stdexcept>
+#include <set>
+#include <sstream>
 
 #include "query.hh"
 
 namespace Notmuch
 {
+    /**
+     * Returns the date of the first message of the query in the given order.
+     */
+    static bool first_date(notmuch_query_t * query, notmuch_sort_t sort, time_t & date)
+    {
+        notmuch_query_set_sort(query, sort);
+
+        auto messages = ptr(notmuch_query_search_messages(query));
+
+        if (!notmuch_messages_valid(messages.get()))
+            return false;
+
+        auto message = ptr(notmuch_messages_get(messages.get()));
+        date = notmuch_message_get_date(message.get());
+
+        return true;
+    }
+
+    std::string restrict_to_dates(const std::string & terms, time_t begin, time_t end)
+    {
+        /* notmuch date ranges include their end. */
+        std::ostringstream range;
+        range << '(' << terms << ") and date:@" << begin << "..@" << (end - 1);
+        return range.str();
+    }
+
+    std::string id_term(const std::string & id)
+    {
+        std::string term("id:\"");
+
+        for (char c : id)
+        {
+            /* Quotes are escaped by doubling them. */
+            if (c == '"')
+                term += '"';
+
+            term += c;
+        }
+
+        return term + '"';
+    }
+
     Query::Query(const std::string & terms, const Database * database)
-        : _query(ptr(notmuch_query_create(database->get(), terms.c_str())))
+        : _database(database),
+            _query(ptr(notmuch_query_create(database->get(), terms.c_str())))
     {
     }
 
@@ -59,12 +104,48 @@ namespace Notmuch
             (_query.get()))), parts);
     }
 
+    ThreadSummaryResults Query::thread_summaries(StringPool & pool)
+    {
+        return ThreadSummaryResults(std::move(ptr(notmuch_query_search_threads
+            (_query.get()))), &pool);
+    }
+
     MessageResults Query::messages(Message::Parts parts)
     {
         return MessageResults(std::move(ptr(notmuch_query_search_messages
             (_query.get()))), parts);
     }
 
+    std::vector<std::string> Query::thread_ids()
+    {
+        std::vector<std::string> ids;
+        std::set<std::string> seen;
+
+        auto messages = ptr(notmuch_query_search_messages(_query.get()));
+
+        for (; notmuch_messages_valid(messages.get());
+            notmuch_messages_move_to_next(messages.get()))
+        {
+            auto message = ptr(notmuch_messages_get(messages.get()));
+            std::string id = notmuch_message_get_thread_id(message.get());
+
+            if (seen.insert(id).second)
+                ids.push_back(id);
+        }
+
+        return ids;
+    }
+
+    bool Query::dates(time_t & oldest, time_t & newest)
+    {
+        /* Use a separate query, so that this one keeps its sort order. */
+        auto query = ptr(notmuch_query_create(_database->get(),
+            notmuch_query_get_query_string(_query.get())));
+
+        return first_date(query.get(), NOTMUCH_SORT_OLDEST_FIRST, oldest)
+            && first_date(query.get(), NOTMUCH_SORT_NEWEST_FIRST, newest);
+    }
+
     unsigned Query::count_messages()
     {
         return notmuch_query_count_messages(_query.get());
@@ -74,6 +155,29 @@ namespace Notmuch
     {
         return notmuch_query_count_threads(_query.get());
     }
+
+    TagResult Query::perform_tag_operations(const TagOperations & ops)
+    {
+        TagResult result = { 0, 0 };
+        Transaction transaction(_database);
+
+        auto messages = ptr(notmuch_query_search_messages(_query.get()));
+
+        for (; notmuch_messages_valid(messages.get());
+            notmuch_messages_move_to_next(messages.get()))
+        {
+            auto message = ptr(notmuch_messages_get(messages.get()));
+
+            if (apply_tag_operations(message.get(), ops))
+                ++result.tagged;
+            else
+                ++result.failed;
+        }
+
+        transaction.commit();
+
+        return result;
+    }
 }
 
 // vim: fdm=syntax fo=croql et sw=4 sts=4 ts=8
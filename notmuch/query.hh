@@ -20,9 +20,14 @@
 #ifndef NER_NOTMUCH_QUERY_H
 #define NER_NOTMUCH_QUERY_H 1
 
+#include <string>
+#include <vector>
+#include <ctime>
 #include <notmuch.h>
 
 #include "database.hh"
+#include "thread_summary.hh"
+#include "tag_operations.hh"
 
 namespace Notmuch
 {
@@ -50,7 +55,7 @@ namespace Notmuch
 
             Iterator<Type, Collection> begin()
             {
-                return Iterator<Type, Collection>(_collection.get());
+                return Iterator<Type, Collection>(_collection.get(), _parts);
             }
 
             Iterator<Type, Collection> end()
@@ -72,6 +77,18 @@ namespace Notmuch
 
     typedef Results<Thread, notmuch_threads_t> ThreadResults;
     typedef Results<Message, notmuch_messages_t> MessageResults;
+    typedef Results<ThreadSummary, notmuch_threads_t> ThreadSummaryResults;
+
+    /**
+     * Restricts a query to messages sent in [begin, end).
+     */
+    std::string restrict_to_dates(const std::string & terms, time_t begin, time_t end);
+
+    /**
+     * Returns a query matching the message with the given ID, quoted so that
+     * the ID is never parsed as query syntax.
+     */
+    std::string id_term(const std::string & id);
 
     class Query
     {
@@ -83,11 +100,44 @@ namespace Notmuch
             MessageResults messages(Message::Parts parts = Message::MetadataPart);
             ThreadResults threads(Thread::Parts parts = Thread::MetadataPart);
 
+            /**
+             * Returns summaries of the matching threads, with their strings
+             * stored in the given pool.
+             */
+            ThreadSummaryResults thread_summaries(StringPool & pool);
+
+            /**
+             * Returns the IDs of the threads containing a matching message.
+             *
+             * This is much cheaper than loading the threads themselves.
+             */
+            std::vector<std::string> thread_ids();
+
+            /**
+             * Finds the dates of the oldest and newest matching messages.
+             *
+             * \return Whether any messages match.
+             */
+            bool dates(time_t & oldest, time_t & newest);
+
             unsigned count_messages();
             unsigned count_threads();
 
+            /**
+             * Applies the tag operations to every message matching the query
+             * in a single atomic transaction.
+             *
+             * The query's database must be opened read-write. Messages which
+             * could not be tagged are counted in the result rather than
+             * aborting the transaction.
+             */
+            TagResult perform_tag_operations(const TagOperations & ops);
+
         private:
+            const Database * _database;
             Pointer<notmuch_query_t> _query;
+
+        friend class ThreadGrouper;
     };
 }
 
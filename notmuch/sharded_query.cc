@@ -0,0 +1,260 @@
+/* ner: notmuch/sharded_query.cc
+ *
+ * Copyright (c) 2013 Michael Forney
+ *
+ * This file is a part of ner.
+ *
+ * ner is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License version 3, as published by the Free
+ * Software Foundation.
+ *
+ * ner is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ner.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <sstream>
+#include <algorithm>
+#include <stdexcept>
+
+#include "sharded_query.hh"
+#include "database_pool.hh"
+
+namespace Notmuch
+{
+    /* Results smaller than this are not worth splitting. */
+    const unsigned minimumSliceSize = 20000;
+
+    /* The number of date ranges counted for each slice, to decide where the
+     * slices begin and end. */
+    const unsigned bucketsPerSlice = 4;
+
+    /* The most threads buffered for each slice that hasn't had its turn yet,
+     * so that slices don't run further ahead than needed. */
+    const unsigned maximumBuffered = 500;
+
+    std::mutex ShardedQuery::_boundaries_mutex;
+    std::map<std::pair<std::string, unsigned>, ShardedQuery::Boundaries> ShardedQuery::_boundaries;
+
+    ShardedQuery::ShardedQuery(const std::string & terms, SortMode sort_mode,
+        StringPool & pool, unsigned slices)
+        : _terms(terms), _sort_mode(sort_mode), _pool(pool),
+            _slice_count(std::max(slices, 1u)), _stopping(false)
+    {
+    }
+
+    ShardedQuery::~ShardedQuery()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stopping = true;
+        }
+
+        _condition.notify_all();
+
+        for (auto & worker : _workers)
+            worker.join();
+    }
+
+    void ShardedQuery::run(const Callback & callback)
+    {
+        for (auto & terms : slice_terms())
+            _slices.push_back({ terms, std::deque<ThreadSummary>(), false });
+
+        for (auto & slice : _slices)
+            _workers.push_back(std::thread(std::bind(&ShardedQuery::search, this, std::ref(slice))));
+
+        std::unique_lock<std::mutex> lock(_mutex);
+
+        for (auto & slice : _slices)
+        {
+            while (true)
+            {
+                _condition.wait(lock, [&slice]() {
+                    return !slice.results.empty() || slice.done;
+                });
+
+                if (slice.results.empty())
+                    break;
+
+                ThreadSummary thread = std::move(slice.results.front());
+                slice.results.pop_front();
+                _condition.notify_all();
+
+                lock.unlock();
+                bool keep_going = add(thread, callback);
+                lock.lock();
+
+                if (!keep_going)
+                {
+                    _stopping = true;
+                    return;
+                }
+            }
+        }
+    }
+
+    std::vector<std::string> ShardedQuery::slice_terms()
+    {
+        auto database = DatabasePool::instance().reader();
+        std::string uuid;
+        unsigned long revision = database->revision(uuid);
+        auto key = std::make_pair(_terms, _slice_count);
+        std::vector<time_t> boundaries;
+        bool counted = false;
+
+        {
+            std::lock_guard<std::mutex> lock(_boundaries_mutex);
+            auto entry = _boundaries.find(key);
+
+            if (entry != _boundaries.end() && entry->second.uuid == uuid
+                && entry->second.revision == revision)
+            {
+                boundaries = entry->second.dates;
+                counted = true;
+            }
+        }
+
+        if (!counted)
+        {
+            boundaries = count_boundaries(database.get());
+
+            std::lock_guard<std::mutex> lock(_boundaries_mutex);
+            _boundaries[key] = Boundaries{ uuid, revision, boundaries };
+        }
+
+        if (boundaries.empty())
+            return { _terms };
+
+        /* The first and last slices are open ended, in case messages were
+         * added in the meantime. */
+        std::vector<std::string> terms;
+        time_t begin = 0;
+
+        for (auto boundary : boundaries)
+        {
+            terms.push_back(restrict_to_dates(_terms, begin, boundary));
+            begin = boundary;
+        }
+
+        std::ostringstream last;
+        last << '(' << _terms << ") and date:@" << begin << "..";
+        terms.push_back(last.str());
+
+        /* Oldest first, the oldest slice comes first; otherwise, the newest
+         * does. */
+        if (_sort_mode != SortMode::OldestFirst)
+            std::reverse(terms.begin(), terms.end());
+
+        return terms;
+    }
+
+    std::vector<time_t> ShardedQuery::count_boundaries(const Database * database)
+    {
+        unsigned total = Query(_terms, database).count_messages();
+
+        unsigned slices = std::min(_slice_count, total / minimumSliceSize);
+
+        if (slices <= 1)
+            return {};
+
+        time_t oldest, newest;
+
+        if (!Query(_terms, database).dates(oldest, newest))
+            return {};
+
+        /* Make the range include the newest message. */
+        ++newest;
+
+        /* Count the messages in equally long date ranges. */
+        unsigned buckets = slices * bucketsPerSlice;
+        time_t width = std::max<time_t>((newest - oldest + buckets - 1) / buckets, 1);
+        std::vector<unsigned> counts;
+
+        for (time_t begin = oldest; begin < newest; begin += width)
+        {
+            counts.push_back(Query(restrict_to_dates(_terms, begin, std::min(begin + width, newest)),
+                database).count_messages());
+        }
+
+        /* Then combine them into slices with about the same number of
+         * messages. */
+        std::vector<time_t> boundaries;
+        unsigned sum = 0;
+
+        for (unsigned bucket = 0; bucket + 1 < counts.size(); ++bucket)
+        {
+            sum += counts[bucket];
+
+            if (sum >= total * (boundaries.size() + 1) / slices)
+                boundaries.push_back(oldest + (bucket + 1) * width);
+        }
+
+        return boundaries;
+    }
+
+    void ShardedQuery::search(Slice & slice)
+    {
+        try
+        {
+            auto database = DatabasePool::instance().reader();
+            Query query(slice.terms, database.get());
+
+            query.set_sort_mode(_sort_mode);
+
+            for (const auto & thread : query.thread_summaries(_pool))
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+
+                _condition.wait(lock, [this, &slice]() {
+                    return _stopping || slice.results.size() < maximumBuffered;
+                });
+
+                if (_stopping)
+                    break;
+
+                slice.results.push_back(thread);
+                _condition.notify_all();
+            }
+        }
+        catch (const std::runtime_error & e)
+        {
+            /* The database could not be opened, so this slice is empty. */
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        slice.done = true;
+        _condition.notify_all();
+    }
+
+    bool ShardedQuery::add(const ThreadSummary & thread, const Callback & callback)
+    {
+        auto entry = _indices.find(thread.id);
+
+        if (entry == _indices.end())
+        {
+            size_t index = _threads.size();
+
+            _indices.insert(std::make_pair(thread.id, index));
+            _threads.push_back(thread);
+
+            return callback(index, true);
+        }
+
+        /* The thread was found in an earlier slice. */
+        ThreadSummary & existing = _threads[entry->second];
+
+        existing.matched_messages += thread.matched_messages;
+        existing.date = std::max(existing.date, thread.date);
+        existing.oldest_date = std::min(existing.oldest_date, thread.oldest_date);
+
+        return callback(entry->second, false);
+    }
+}
+
+// vim: fdm=syntax fo=croql et sw=4 sts=4 ts=8
+
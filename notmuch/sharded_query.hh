@@ -0,0 +1,127 @@
+/* ner: notmuch/sharded_query.hh
+ *
+ * Copyright (c) 2013 Michael Forney
+ *
+ * This file is a part of ner.
+ *
+ * ner is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License version 3, as published by the Free
+ * Software Foundation.
+ *
+ * ner is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ner.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NER_NOTMUCH_SHARDED_QUERY_H
+#define NER_NOTMUCH_SHARDED_QUERY_H 1
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <functional>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <ctime>
+
+#include "notmuch/query.hh"
+#include "notmuch/thread_summary.hh"
+#include "notmuch/string_pool.hh"
+
+namespace Notmuch
+{
+    /**
+     * Searches for threads in several date ranges at the same time.
+     *
+     * The query is split into slices of roughly the same number of messages,
+     * using a histogram of message dates. Each slice is searched on its own
+     * thread and database connection. Since a thread is sorted by the date of
+     * its newest (or oldest) matching message, the results of the slices
+     * only need to be put one after the other to be in order. The results of
+     * the first slice are passed on as soon as they are found, while the rest
+     * are buffered until their turn.
+     *
+     * A thread with matching messages in more than one slice is only listed
+     * once, at its first position, with the matching messages of each slice
+     * added up.
+     *
+     * Counting the histogram takes a query per date range, so where the
+     * slices begin and end is remembered for each search, until the database
+     * revision changes.
+     */
+    class ShardedQuery
+    {
+        public:
+            /**
+             * Called after each thread with its index, and whether it was
+             * just found.
+             *
+             * \return Whether to keep going.
+             */
+            typedef std::function<bool (size_t index, bool added)> Callback;
+
+            /**
+             * \param slices The maximum number of slices to search at once.
+             */
+            ShardedQuery(const std::string & terms, SortMode sort_mode,
+                StringPool & pool, unsigned slices);
+            ~ShardedQuery();
+
+            void run(const Callback & callback);
+
+            size_t size() const { return _threads.size(); }
+            const ThreadSummary & summary(size_t index) const { return _threads[index]; }
+
+        private:
+            struct Slice
+            {
+                std::string terms;
+                std::deque<ThreadSummary> results;
+                bool done;
+            };
+
+            /* Where the slices of a search began and ended, and the database
+             * revision they were counted at. */
+            struct Boundaries
+            {
+                std::string uuid;
+                unsigned long revision;
+                std::vector<time_t> dates;
+            };
+
+            std::vector<std::string> slice_terms();
+            std::vector<time_t> count_boundaries(const Database * database);
+            void search(Slice & slice);
+            bool add(const ThreadSummary & thread, const Callback & callback);
+
+            std::string _terms;
+            SortMode _sort_mode;
+            StringPool & _pool;
+            unsigned _slice_count;
+
+            std::mutex _mutex;
+            std::condition_variable _condition;
+            std::deque<Slice> _slices;
+            std::vector<std::thread> _workers;
+            bool _stopping;
+
+            std::vector<ThreadSummary> _threads;
+            std::unordered_map<std::string, size_t> _indices;
+
+            /* Keyed by the search terms and the number of slices. */
+            static std::mutex _boundaries_mutex;
+            static std::map<std::pair<std::string, unsigned>, Boundaries> _boundaries;
+    };
+}
+
+#endif
+
+// vim: fdm=syntax fo=croql et sw=4 sts=4 ts=8
+
@@ -0,0 +1,114 @@
+/* ner: notmuch/string_pool.cc
+ *
+ * Copyright (c) 2013 Michael Forney
+ *
+ * This file is a part of ner.
+ *
+ * ner is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License version 3, as published by the Free
+ * Software Foundation.
+ *
+ * ner is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ner.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "string_pool.hh"
+
+namespace Notmuch
+{
+    size_t StringPool::Hash::operator()(const char * string) const
+    {
+        /* FNV-1a */
+        size_t hash = 2166136261u;
+
+        for (; *string; ++string)
+        {
+            hash ^= static_cast<unsigned char>(*string);
+            hash *= 16777619u;
+        }
+
+        return hash;
+    }
+
+    StringPool::StringPool(size_t block_size)
+        : _position(nullptr), _remaining(0), _block_size(block_size), _allocated(0)
+    {
+    }
+
+    const char * StringPool::intern(const char * string)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        auto existing = _strings.find(string);
+
+        if (existing != _strings.end())
+            return *existing;
+
+        const char * pooled = copy(string, std::strlen(string));
+        _strings.insert(pooled);
+
+        return pooled;
+    }
+
+    const char * StringPool::intern(const std::string & string)
+    {
+        return intern(string.c_str());
+    }
+
+    const char * StringPool::store(const char * string)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        return copy(string, std::strlen(string));
+    }
+
+    size_t StringPool::allocated() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        return _allocated;
+    }
+
+    const char * StringPool::copy(const char * string, size_t length)
+    {
+        size_t size = length + 1;
+
+        if (size > _remaining)
+        {
+            /* Strings larger than a block get a block of their own, so that the
+             * rest of the current block isn't wasted. */
+            if (size > _block_size / 4)
+            {
+                _blocks.emplace_back(new char[size]);
+                _allocated += size;
+
+                char * block = _blocks.back().get();
+                std::memcpy(block, string, size);
+
+                return block;
+            }
+
+            _blocks.emplace_back(new char[_block_size]);
+            _allocated += _block_size;
+
+            _position = _blocks.back().get();
+            _remaining = _block_size;
+        }
+
+        char * pooled = _position;
+        std::memcpy(pooled, string, size);
+
+        _position += size;
+        _remaining -= size;
+
+        return pooled;
+    }
+}
+
+// vim: fdm=syntax fo=croql et sw=4 sts=4 ts=8
+
@@ -0,0 +1,93 @@
+/* ner: notmuch/string_pool.hh
+ *
+ * Copyright (c) 2013 Michael Forney
+ *
+ * This file is a part of ner.
+ *
+ * ner is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License version 3, as published by the Free
+ * Software Foundation.
+ *
+ * ner is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ner.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NER_NOTMUCH_STRING_POOL_H
+#define NER_NOTMUCH_STRING_POOL_H 1
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <unordered_set>
+
+namespace Notmuch
+{
+    /**
+     * Stores strings in large blocks of memory.
+     *
+     * Strings stored in the pool keep their address until the pool is
+     * destroyed, so they can be read from any thread without locking.
+     */
+    class StringPool
+    {
+        public:
+            StringPool(size_t block_size = 64 * 1024);
+            StringPool(const StringPool & other) = delete;
+
+            /**
+             * Returns a pooled copy of the string, storing it only if an equal
+             * string has not been interned before.
+             */
+            const char * intern(const char * string);
+            const char * intern(const std::string & string);
+
+            /**
+             * Returns a pooled copy of the string without looking for an
+             * existing copy. This is cheaper for strings known to be unique.
+             */
+            const char * store(const char * string);
+
+            /**
+             * Returns the number of bytes allocated by the pool.
+             */
+            size_t allocated() const;
+
+        private:
+            struct Hash
+            {
+                size_t operator()(const char * string) const;
+            };
+
+            struct Equal
+            {
+                bool operator()(const char * a, const char * b) const
+                {
+                    return std::strcmp(a, b) == 0;
+                }
+            };
+
+            const char * copy(const char * string, size_t length);
+
+            mutable std::mutex _mutex;
+            std::vector<std::unique_ptr<char[]>> _blocks;
+            char * _position;
+            size_t _remaining;
+            size_t _block_size;
+            size_t _allocated;
+
+            std::unordered_set<const char *, Hash, Equal> _strings;
+    };
+}
+
+#endif
+
+// vim: fdm=syntax fo=croql et sw=4 sts=4 ts=8
+
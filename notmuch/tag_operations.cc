@@ -17,6 +17,8 @@
  * ner.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <sstream>
+
 #include "tag_operations.hh"
 
 namespace Notmuch
@@ -35,6 +37,87 @@ namespace Notmuch
     {
         return { TagOperation::Clear, std::string() };
     }
+
+    bool parse_tag_operations(const std::string & string, TagOperations & ops)
+    {
+        std::istringstream stream(string);
+        std::string word;
+
+        while (stream >> word)
+        {
+            if (word.size() < 2)
+                return false;
+
+            switch (word[0])
+            {
+                case '+':
+                    ops.push_back(add_operation(word.substr(1)));
+                    break;
+                case '-':
+                    ops.push_back(remove_operation(word.substr(1)));
+                    break;
+                default:
+                    return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool apply_tag_operations(notmuch_message_t * message, const TagOperations & ops)
+    {
+        if (notmuch_message_freeze(message) != NOTMUCH_STATUS_SUCCESS)
+            return false;
+
+        bool success = true;
+
+        for (auto & op : ops)
+        {
+            notmuch_status_t status = NOTMUCH_STATUS_SUCCESS;
+
+            switch (op.type)
+            {
+                case TagOperation::Add:
+                    status = notmuch_message_add_tag(message, op.tag.c_str());
+                    break;
+                case TagOperation::Remove:
+                    status = notmuch_message_remove_tag(message, op.tag.c_str());
+                    break;
+                case TagOperation::Clear:
+                    status = notmuch_message_remove_all_tags(message);
+                    break;
+            }
+
+            if (status != NOTMUCH_STATUS_SUCCESS)
+                success = false;
+        }
+
+        /* Thaw even if an operation failed, so that the rest is committed
+         * and the freeze count stays balanced. */
+        if (notmuch_message_thaw(message) != NOTMUCH_STATUS_SUCCESS)
+            return false;
+
+        return success;
+    }
+
+    void apply_tag_operations(TagSet & tags, const TagOperations & ops)
+    {
+        for (auto & op : ops)
+        {
+            switch (op.type)
+            {
+                case TagOperation::Add:
+                    tags.insert(op.tag);
+                    break;
+                case TagOperation::Remove:
+                    tags.erase(op.tag);
+                    break;
+                case TagOperation::Clear:
+                    tags.clear();
+                    break;
+            }
+        }
+    }
 }
 
 // vim: fdm=syntax fo=croql et sw=4 sts=4 ts=8
@@ -22,6 +22,9 @@
 
 #include <string>
 #include <vector>
+#include <notmuch.h>
+
+#include "notmuch/tag_set.hh"
 
 namespace Notmuch
 {
@@ -40,9 +43,35 @@ namespace Notmuch
 
     typedef std::vector<TagOperation> TagOperations;
 
+    /**
+     * The outcome of applying tag operations to a set of messages.
+     */
+    struct TagResult
+    {
+        unsigned tagged;
+        unsigned failed;
+    };
+
     TagOperation add_operation(const std::string & tag);
     TagOperation remove_operation(const std::string & tag);
     TagOperation clear_operation();
+
+    /**
+     * Parses a list of tag operations, such as "+flagged -inbox".
+     *
+     * \return Whether the string was a valid list of tag operations.
+     */
+    bool parse_tag_operations(const std::string & string, TagOperations & ops);
+
+    /**
+     * Applies the tag operations to a message in the database.
+     */
+    bool apply_tag_operations(notmuch_message_t * message, const TagOperations & ops);
+
+    /**
+     * Applies the tag operations to an in-memory set of tags.
+     */
+    void apply_tag_operations(TagSet & tags, const TagOperations & ops);
 }
 
 #endif
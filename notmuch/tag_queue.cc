@@ -0,0 +1,228 @@
+/* ner: notmuch/tag_queue.cc
+ *
+ * Copyright (c) 2013 Michael Forney
+ *
+ * This file is a part of ner.
+ *
+ * ner is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License version 3, as published by the Free
+ * Software Foundation.
+ *
+ * ner is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ner.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "tag_queue.hh"
+#include "database_pool.hh"
+#include "query.hh"
+
+namespace Notmuch
+{
+    /* How long to wait for more operations before writing a batch. */
+    const auto coalesceDelay = std::chrono::milliseconds(250);
+
+    const auto initialRetryDelay = std::chrono::milliseconds(100);
+    const auto maximumRetryDelay = std::chrono::seconds(10);
+
+    /**
+     * Removes operations which are overridden by later ones.
+     */
+    static void coalesce(TagOperations & ops)
+    {
+        TagOperations coalesced;
+
+        for (auto & op : ops)
+        {
+            if (op.type == TagOperation::Clear)
+                coalesced.clear();
+            else
+            {
+                coalesced.erase(std::remove_if(coalesced.begin(), coalesced.end(),
+                    [&op](const TagOperation & other) { return other.tag == op.tag; }),
+                    coalesced.end());
+            }
+
+            coalesced.push_back(op);
+        }
+
+        ops.swap(coalesced);
+    }
+
+    TagQueue * TagQueue::_instance = nullptr;
+
+    TagQueue & TagQueue::instance()
+    {
+        return *_instance;
+    }
+
+    TagQueue::TagQueue()
+        : _failed(0), _flushing(false), _stopping(false)
+    {
+        _instance = this;
+
+        _thread = std::thread(std::bind(&TagQueue::run, this));
+    }
+
+    TagQueue::~TagQueue()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stopping = true;
+        }
+
+        _condition.notify_all();
+        _thread.join();
+
+        _instance = nullptr;
+    }
+
+    void TagQueue::enqueue(const std::string & terms, const TagOperations & ops)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+
+            /* Merge with the previous entry if it is for the same query. Entries
+             * further back can't be merged with, since an entry in between may
+             * affect the same messages. */
+            if (!_entries.empty() && _entries.back().terms == terms)
+            {
+                auto & entry = _entries.back();
+                entry.ops.insert(entry.ops.end(), ops.begin(), ops.end());
+                coalesce(entry.ops);
+            }
+            else
+            {
+                _entries.push_back({ terms, ops });
+                coalesce(_entries.back().ops);
+            }
+        }
+
+        _condition.notify_all();
+    }
+
+    unsigned TagQueue::pending() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _entries.size() + _batch.size();
+    }
+
+    unsigned TagQueue::failed() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _failed;
+    }
+
+    bool TagQueue::flush(std::chrono::milliseconds timeout)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+
+        _flushing = true;
+        _condition.notify_all();
+
+        bool flushed = _condition.wait_for(lock, timeout, [this]() {
+            return _entries.empty() && _batch.empty();
+        });
+
+        _flushing = false;
+
+        return flushed;
+    }
+
+    void TagQueue::set_change_listener(const std::function<void ()> & listener)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _change_listener = listener;
+    }
+
+    void TagQueue::run()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        auto retryDelay = std::chrono::milliseconds(initialRetryDelay);
+
+        while (true)
+        {
+            _condition.wait(lock, [this]() { return !_entries.empty() || _stopping; });
+
+            if (_entries.empty())
+                break;
+
+            /* Give the UI a chance to queue more operations, so that they end up
+             * in the same transaction. */
+            _condition.wait_for(lock, coalesceDelay, [this]() {
+                return _flushing || _stopping;
+            });
+
+            _batch.assign(_entries.begin(), _entries.end());
+            _entries.clear();
+
+            lock.unlock();
+            bool written = write(_batch);
+            lock.lock();
+
+            if (_change_listener)
+                _change_listener();
+
+            if (written)
+            {
+                _batch.clear();
+                retryDelay = initialRetryDelay;
+
+                /* Wake up anyone waiting in flush. */
+                _condition.notify_all();
+            }
+            else
+            {
+                /* Put the batch back in front of anything queued in the
+                 * meantime, and try again later. */
+                _entries.insert(_entries.begin(), _batch.begin(), _batch.end());
+                _batch.clear();
+
+                if (_stopping)
+                    break;
+
+                _condition.wait_for(lock, retryDelay, [this]() { return _stopping; });
+                retryDelay = std::min<std::chrono::milliseconds>(retryDelay * 2,
+                    maximumRetryDelay);
+            }
+        }
+    }
+
+    bool TagQueue::write(const std::vector<Entry> & batch)
+    {
+        try
+        {
+            auto database = DatabasePool::instance().writer();
+            unsigned failed = 0;
+            Transaction transaction(database.get());
+
+            for (auto & entry : batch)
+            {
+                Query query(entry.terms, database.get());
+                failed += query.perform_tag_operations(entry.ops).failed;
+            }
+
+            transaction.commit();
+
+            std::lock_guard<std::mutex> lock(_mutex);
+            _failed += failed;
+
+            return true;
+        }
+        catch (const std::runtime_error & e)
+        {
+            /* Most likely, someone else holds the write lock. */
+            return false;
+        }
+    }
+}
+
+// vim: fdm=syntax fo=croql et sw=4 sts=4 ts=8
+
@@ -0,0 +1,114 @@
+/* ner: notmuch/tag_queue.hh
+ *
+ * Copyright (c) 2013 Michael Forney
+ *
+ * This file is a part of ner.
+ *
+ * ner is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License version 3, as published by the Free
+ * Software Foundation.
+ *
+ * ner is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ner.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NER_NOTMUCH_TAG_QUEUE_H
+#define NER_NOTMUCH_TAG_QUEUE_H 1
+
+#include <string>
+#include <deque>
+#include <vector>
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "notmuch/tag_operations.hh"
+
+namespace Notmuch
+{
+    /**
+     * Writes tag operations to the database in the background.
+     *
+     * Queued operations are written by a writer thread in batches, each batch
+     * in a single transaction. Operations queued shortly after each other are
+     * coalesced into the same batch. If the database cannot be opened for
+     * writing, for example because notmuch new holds the write lock, the batch
+     * is retried with an increasing delay.
+     *
+     * This class is a singleton.
+     */
+    class TagQueue
+    {
+        public:
+            static TagQueue & instance();
+
+            TagQueue();
+            ~TagQueue();
+
+            /**
+             * Queues tag operations for every message matching the query.
+             */
+            void enqueue(const std::string & terms, const TagOperations & ops);
+
+            /**
+             * Returns the number of queries with tag operations that have not
+             * been written yet.
+             */
+            unsigned pending() const;
+
+            /**
+             * Returns the number of messages that could not be tagged so far.
+             */
+            unsigned failed() const;
+
+            /**
+             * Writes all queued operations, waiting at most timeout.
+             *
+             * \return Whether every queued operation was written.
+             */
+            bool flush(std::chrono::milliseconds timeout);
+
+            /**
+             * Sets a function to call whenever a batch was written or failed
+             * to be written. It is called from the writer thread.
+             */
+            void set_change_listener(const std::function<void ()> & listener);
+
+        private:
+            struct Entry
+            {
+                std::string terms;
+                TagOperations ops;
+            };
+
+            void run();
+            bool write(const std::vector<Entry> & batch);
+
+            static TagQueue * _instance;
+
+            mutable std::mutex _mutex;
+            std::condition_variable _condition;
+            std::thread _thread;
+
+            std::deque<Entry> _entries;
+            std::vector<Entry> _batch;
+            unsigned _failed;
+
+            std::function<void ()> _change_listener;
+
+            bool _flushing;
+            bool _stopping;
+    };
+}
+
+#endif
+
+// vim: fdm=syntax fo=croql et sw=4 sts=4 ts=8
+
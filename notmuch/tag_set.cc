@@ -0,0 +1,251 @@
+/* ner: notmuch/tag_set.cc
+ *
+ * Copyright (c) 2013 Michael Forney
+ *
+ * This file is a part of ner.
+ *
+ * ner is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License version 3, as published by the Free
+ * Software Foundation.
+ *
+ * ner is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ner.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <notmuch.h>
+
+#include "tag_set.hh"
+#include "database_pool.hh"
+#include "util.hh"
+
+namespace Notmuch
+{
+    TagDictionary * TagDictionary::_instance = nullptr;
+
+    TagDictionary & TagDictionary::instance()
+    {
+        return *_instance;
+    }
+
+    TagDictionary::TagDictionary()
+    {
+        _instance = this;
+
+        auto database = DatabasePool::instance().reader();
+        auto tags = ptr(notmuch_database_get_all_tags(database->get()));
+
+        for (; notmuch_tags_valid(tags.get()); notmuch_tags_move_to_next(tags.get()))
+            id(notmuch_tags_get(tags.get()));
+
+        _unread = id("unread");
+    }
+
+    TagDictionary::~TagDictionary()
+    {
+        _instance = nullptr;
+    }
+
+    TagId TagDictionary::id(const std::string & name)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        auto entry = _ids.find(name);
+
+        if (entry != _ids.end())
+            return entry->second;
+
+        TagId id = _names.size();
+        _names.push_back(name);
+        _ids.insert(std::make_pair(name, id));
+
+        return id;
+    }
+
+    bool TagDictionary::find(const std::string & name, TagId & id) const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        auto entry = _ids.find(name);
+
+        if (entry == _ids.end())
+            return false;
+
+        id = entry->second;
+        return true;
+    }
+
+    const std::string & TagDictionary::name(TagId id) const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _names.at(id);
+    }
+
+    TagSet::TagSet()
+        : _word(0)
+    {
+    }
+
+    bool TagSet::contains(TagId id) const
+    {
+        return word(id / word_bits) & (uint64_t(1) << (id % word_bits));
+    }
+
+    bool TagSet::contains(const std::string & name) const
+    {
+        TagId id;
+        return TagDictionary::instance().find(name, id) && contains(id);
+    }
+
+    void TagSet::insert(TagId id)
+    {
+        word(id / word_bits) |= uint64_t(1) << (id % word_bits);
+    }
+
+    void TagSet::insert(const std::string & name)
+    {
+        insert(TagDictionary::instance().id(name));
+    }
+
+    void TagSet::erase(TagId id)
+    {
+        if (id / word_bits > _overflow.size())
+            return;
+
+        word(id / word_bits) &= ~(uint64_t(1) << (id % word_bits));
+        trim();
+    }
+
+    void TagSet::erase(const std::string & name)
+    {
+        TagId id;
+
+        if (TagDictionary::instance().find(name, id))
+            erase(id);
+    }
+
+    void TagSet::clear()
+    {
+        _word = 0;
+        _overflow.clear();
+    }
+
+    bool TagSet::empty() const
+    {
+        /* The overflow words are trimmed, so the last one is never empty. */
+        return _word == 0 && _overflow.empty();
+    }
+
+    unsigned TagSet::size() const
+    {
+        unsigned count = __builtin_popcountll(_word);
+
+        for (auto word : _overflow)
+            count += __builtin_popcountll(word);
+
+        return count;
+    }
+
+    TagSet & TagSet::operator|=(const TagSet & other)
+    {
+        _word |= other._word;
+
+        if (_overflow.size() < other._overflow.size())
+            _overflow.resize(other._overflow.size());
+
+        for (unsigned index = 0; index < other._overflow.size(); ++index)
+            _overflow[index] |= other._overflow[index];
+
+        return *this;
+    }
+
+    TagSet & TagSet::operator-=(const TagSet & other)
+    {
+        _word &= ~other._word;
+
+        for (unsigned index = 0; index < std::min(_overflow.size(), other._overflow.size()); ++index)
+            _overflow[index] &= ~other._overflow[index];
+
+        trim();
+
+        return *this;
+    }
+
+    TagSet & TagSet::operator&=(const TagSet & other)
+    {
+        _word &= other._word;
+
+        _overflow.resize(std::min(_overflow.size(), other._overflow.size()));
+
+        for (unsigned index = 0; index < _overflow.size(); ++index)
+            _overflow[index] &= other._overflow[index];
+
+        trim();
+
+        return *this;
+    }
+
+    bool TagSet::operator==(const TagSet & other) const
+    {
+        return _word == other._word && _overflow == other._overflow;
+    }
+
+    std::vector<TagId> TagSet::ids() const
+    {
+        std::vector<TagId> ids;
+
+        for (unsigned index = 0; index <= _overflow.size(); ++index)
+        {
+            for (uint64_t bits = word(index); bits; bits &= bits - 1)
+                ids.push_back(index * word_bits + __builtin_ctzll(bits));
+        }
+
+        return ids;
+    }
+
+    std::vector<std::string> TagSet::names() const
+    {
+        auto & dictionary = TagDictionary::instance();
+        std::vector<std::string> names;
+
+        for (auto id : ids())
+            names.push_back(dictionary.name(id));
+
+        std::sort(names.begin(), names.end());
+
+        return names;
+    }
+
+    uint64_t TagSet::word(unsigned index) const
+    {
+        if (index == 0)
+            return _word;
+
+        return index <= _overflow.size() ? _overflow[index - 1] : 0;
+    }
+
+    uint64_t & TagSet::word(unsigned index)
+    {
+        if (index == 0)
+            return _word;
+
+        if (index > _overflow.size())
+            _overflow.resize(index);
+
+        return _overflow[index - 1];
+    }
+
+    void TagSet::trim()
+    {
+        while (!_overflow.empty() && _overflow.back() == 0)
+            _overflow.pop_back();
+    }
+}
+
+// vim: fdm=syntax fo=croql et sw=4 sts=4 ts=8
+
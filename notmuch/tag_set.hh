@@ -0,0 +1,138 @@
+/* ner: notmuch/tag_set.hh
+ *
+ * Copyright (c) 2013 Michael Forney
+ *
+ * This file is a part of ner.
+ *
+ * ner is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License version 3, as published by the Free
+ * Software Foundation.
+ *
+ * ner is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ner.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NER_NOTMUCH_TAG_SET_H
+#define NER_NOTMUCH_TAG_SET_H 1
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+namespace Notmuch
+{
+    typedef uint32_t TagId;
+
+    /**
+     * Assigns a small integer to every tag name.
+     *
+     * The dictionary is seeded with the tags in the database, and tags created
+     * later are added the first time they are seen. IDs are never reused, so
+     * they stay valid for the lifetime of the process.
+     *
+     * This class is a singleton.
+     */
+    class TagDictionary
+    {
+        public:
+            static TagDictionary & instance();
+
+            TagDictionary();
+            ~TagDictionary();
+
+            /**
+             * Returns the ID of the tag, adding it to the dictionary if
+             * necessary.
+             */
+            TagId id(const std::string & name);
+
+            /**
+             * Looks up the ID of the tag without adding it.
+             *
+             * \return Whether the tag is in the dictionary.
+             */
+            bool find(const std::string & name, TagId & id) const;
+
+            const std::string & name(TagId id) const;
+
+            /**
+             * The ID of the "unread" tag, which is checked for on every row.
+             */
+            TagId unread() const { return _unread; }
+
+        private:
+            static TagDictionary * _instance;
+
+            mutable std::mutex _mutex;
+            std::unordered_map<std::string, TagId> _ids;
+
+            /* A deque, so that references to the names stay valid. */
+            std::deque<std::string> _names;
+
+            TagId _unread;
+    };
+
+    /**
+     * A set of tags, stored as a bitset of tag IDs.
+     *
+     * The first 64 tags are stored inline, so copying a set is cheap for most
+     * databases.
+     */
+    class TagSet
+    {
+        public:
+            TagSet();
+
+            bool contains(TagId id) const;
+            bool contains(const std::string & name) const;
+
+            void insert(TagId id);
+            void insert(const std::string & name);
+            void erase(TagId id);
+            void erase(const std::string & name);
+            void clear();
+
+            bool empty() const;
+            unsigned size() const;
+
+            TagSet & operator|=(const TagSet & other);
+            TagSet & operator-=(const TagSet & other);
+            TagSet & operator&=(const TagSet & other);
+
+            bool operator==(const TagSet & other) const;
+            bool operator!=(const TagSet & other) const { return !operator==(other); }
+
+            /**
+             * Returns the IDs of the tags in the set, in increasing order.
+             */
+            std::vector<TagId> ids() const;
+
+            /**
+             * Returns the names of the tags in the set, sorted by name.
+             */
+            std::vector<std::string> names() const;
+
+        private:
+            static const unsigned word_bits = 64;
+
+            uint64_t word(unsigned index) const;
+            uint64_t & word(unsigned index);
+            void trim();
+
+            uint64_t _word;
+            std::vector<uint64_t> _overflow;
+    };
+}
+
+#endif
+
+// vim: fdm=syntax fo=croql et sw=4 sts=4 ts=8
+
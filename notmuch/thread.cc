@@ -18,32 +18,56 @@
  */
 
 #include "thread.hh"
+#include "tag_queue.hh"
 
 namespace Notmuch
 {
+    Thread::Thread()
+        : total_messages(0), matched_messages(0)
+    {
+    }
+
     Thread::Thread(notmuch_thread_t * thread, Parts parts)
+        : total_messages(0), matched_messages(0)
     {
         if (parts & MetadataPart)
         {
             id = notmuch_thread_get_thread_id(thread);
             subject = notmuch_thread_get_subject(thread);
-            authors = notmuch_thread_get_authors(thread) ?: "(null)";
             date = std::chrono::system_clock::from_time_t(
                 notmuch_thread_get_newest_date(thread));
             matched_messages = notmuch_thread_get_matched_messages(thread);
             total_messages = notmuch_thread_get_total_messages(thread);
+        }
+
+        if (parts & AuthorsPart)
+            authors = notmuch_thread_get_authors(thread) ?: "(null)";
 
+        if (parts & TagsPart)
+        {
+            auto & dictionary = TagDictionary::instance();
             notmuch_tags_t * notmuch_tags;
             for (notmuch_tags = notmuch_thread_get_tags(thread);
                 notmuch_tags_valid(notmuch_tags);
                 notmuch_tags_move_to_next(notmuch_tags))
             {
-                tags.insert(notmuch_tags_get(notmuch_tags));
+                tags.insert(dictionary.id(notmuch_tags_get(notmuch_tags)));
             }
         }
 
         if (parts & TreePart)
-            build_message_tree(tree, notmuch_thread_get_toplevel_messages(thread));
+            tree = MessageTree(notmuch_thread_get_toplevel_messages(thread),
+                TreeMessageParts);
+    }
+
+    void Thread::perform_tag_operations(const TagOperations & ops)
+    {
+        apply_tag_operations(tags, ops);
+
+        for (auto & node : tree)
+            apply_tag_operations(node.message.tags, ops);
+
+        TagQueue::instance().enqueue("thread:" + id, ops);
     }
 }
 
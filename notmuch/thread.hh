@@ -21,14 +21,13 @@
 #define NER_NOTMUCH_THREAD_H 1
 
 #include <chrono>
-#include <set>
 #include <string>
 #include <notmuch.h>
 
 #include "util.hh"
-#include "tree.hh"
 #include "iterator.hh"
 #include "message.hh"
+#include "message_tree.hh"
 
 namespace Notmuch
 {
@@ -38,25 +37,45 @@ namespace Notmuch
             enum
             {
                 MetadataPart    = 1 << 0,
-                TreePart        = 1 << 1
+                AuthorsPart     = 1 << 1,
+                TagsPart        = 1 << 2,
+                TreePart        = 1 << 3
             };
 
             typedef unsigned int Parts;
             static const Parts AllParts = ~0;
 
-            Thread() = default;
+            /**
+             * The parts loaded for each message of the tree when TreePart is
+             * requested.
+             */
+            static const Message::Parts TreeMessageParts = Message::MetadataPart
+                | Message::TagsPart | Message::HeadersPart;
+
+            Thread();
 
             /* Metadata */
             std::string id;
             std::string subject;
-            std::string authors;
             std::chrono::system_clock::time_point date;
-            std::set<std::string> tags;
             int total_messages;
             int matched_messages;
 
+            /* Authors */
+            std::string authors;
+
+            /* Tags */
+            TagSet tags;
+
             /* Message Tree */
-            Tree<Message> tree;
+            MessageTree tree;
+
+            /**
+             * Applies the tag operations to the thread's tags and the tags of
+             * each message in its tree, and queues them to be written to
+             * every message of the thread.
+             */
+            void perform_tag_operations(const TagOperations & ops);
 
         private:
             Thread(notmuch_thread_t * thread, Parts parts = AllParts);
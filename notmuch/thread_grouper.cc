@@ -0,0 +1,143 @@
+/* ner: notmuch/thread_grouper.cc
+ *
+ * Copyright (c) 2013 Michael Forney
+ *
+ * This file is a part of ner.
+ *
+ * ner is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License version 3, as published by the Free
+ * Software Foundation.
+ *
+ * ner is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ner.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#include "thread_grouper.hh"
+#include "tag_set.hh"
+
+namespace Notmuch
+{
+    /* Once a thread's list of authors is this long, no more are added. Each
+     * version of the list is kept in the string pool, and the start of it
+     * is all that is ever shown. */
+    const size_t maximumAuthorListLength = 200;
+
+    /**
+     * Returns the name from a From header, or the address if there is none.
+     */
+    static std::string author_name(const char * from)
+    {
+        std::string author(from);
+        size_t address = author.find('<');
+
+        if (address == std::string::npos)
+            return author;
+
+        std::string name = author.substr(0, address);
+        name.erase(name.find_last_not_of(" \t") + 1);
+
+        if (name.size() >= 2 && name.front() == '"' && name.back() == '"')
+            name = name.substr(1, name.size() - 2);
+
+        if (name.empty())
+            return author.substr(address + 1, author.find('>', address) - address - 1);
+
+        return name;
+    }
+
+    ThreadGrouper::ThreadGrouper(StringPool & pool)
+        : _pool(pool)
+    {
+    }
+
+    void ThreadGrouper::group(Query & query, const Callback & callback)
+    {
+        auto & dictionary = TagDictionary::instance();
+        auto messages = ptr(notmuch_query_search_messages(query._query.get()));
+
+        for (; notmuch_messages_valid(messages.get());
+            notmuch_messages_move_to_next(messages.get()))
+        {
+            auto message = ptr(notmuch_messages_get(messages.get()));
+            const char * thread_id = notmuch_message_get_thread_id(message.get());
+            auto date = std::chrono::system_clock::from_time_t(
+                notmuch_message_get_date(message.get()));
+
+            auto entry = _indices.find(thread_id);
+            bool added = entry == _indices.end();
+            size_t index;
+
+            if (added)
+            {
+                index = _threads.size();
+                _indices.insert(std::make_pair(thread_id, index));
+
+                _threads.push_back(Thread());
+                auto & summary = _threads.back().summary;
+
+                summary.id = _pool.store(thread_id);
+                summary.subject = _pool.intern(
+                    notmuch_message_get_header(message.get(), "subject") ?: "");
+                summary.date = date;
+                summary.oldest_date = date;
+            }
+            else
+            {
+                index = entry->second;
+                auto & summary = _threads[index].summary;
+
+                summary.date = std::max(summary.date, date);
+                summary.oldest_date = std::min(summary.oldest_date, date);
+            }
+
+            Thread & thread = _threads[index];
+            ++thread.summary.matched_messages;
+
+            notmuch_tags_t * tags;
+            for (tags = notmuch_message_get_tags(message.get());
+                notmuch_tags_valid(tags);
+                notmuch_tags_move_to_next(tags))
+            {
+                thread.summary.tags.insert(dictionary.id(notmuch_tags_get(tags)));
+            }
+
+            add_author(thread, notmuch_message_get_header(message.get(), "from") ?: "(null)");
+
+            if (!callback(index, added))
+                break;
+        }
+    }
+
+    void ThreadGrouper::add_author(Thread & thread, const char * from)
+    {
+        if (thread.author_list.size() >= maximumAuthorListLength)
+            return;
+
+        std::string name = author_name(from);
+
+        if (std::find(thread.authors.begin(), thread.authors.end(), name)
+            != thread.authors.end())
+        {
+            return;
+        }
+
+        thread.authors.push_back(name);
+
+        /* Authors are listed in the order their messages were found. */
+        if (!thread.author_list.empty())
+            thread.author_list.append(", ");
+
+        thread.author_list.append(name);
+        thread.summary.authors = _pool.intern(thread.author_list);
+    }
+}
+
+// vim: fdm=syntax fo=croql et sw=4 sts=4 ts=8
+
@@ -0,0 +1,99 @@
+/* ner: notmuch/thread_grouper.hh
+ *
+ * Copyright (c) 2013 Michael Forney
+ *
+ * This file is a part of ner.
+ *
+ * ner is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License version 3, as published by the Free
+ * Software Foundation.
+ *
+ * ner is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ner.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NER_NOTMUCH_THREAD_GROUPER_H
+#define NER_NOTMUCH_THREAD_GROUPER_H 1
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <unordered_map>
+#include <notmuch.h>
+
+#include "notmuch/thread_summary.hh"
+#include "notmuch/string_pool.hh"
+#include "notmuch/query.hh"
+
+namespace Notmuch
+{
+    /**
+     * How the threads matching a search are found.
+     */
+    enum class ThreadEngine
+    {
+        /* Let notmuch build each thread. */
+        Threads,
+
+        /* Group the matching messages by thread as they are found. */
+        Messages
+    };
+
+    /**
+     * Groups the messages matching a query into threads.
+     *
+     * notmuch_query_search_threads builds every thread, including the messages
+     * which don't match, before returning the first one. Instead, this goes
+     * through the matching messages in sort order, so that a thread is known
+     * as soon as its first message is found, and is updated as the rest of
+     * its messages come in. Threads end up in the same order as notmuch's.
+     *
+     * Only matching messages are looked at, so the summaries have no total
+     * message count, and only list the authors of the matching messages. The
+     * list stops at a line's worth of authors.
+     */
+    class ThreadGrouper
+    {
+        public:
+            /**
+             * Called after each message with the index of its thread, and
+             * whether the thread was just found.
+             *
+             * \return Whether to keep going.
+             */
+            typedef std::function<bool (size_t index, bool added)> Callback;
+
+            ThreadGrouper(StringPool & pool);
+
+            void group(Query & query, const Callback & callback);
+
+            size_t size() const { return _threads.size(); }
+            const ThreadSummary & summary(size_t index) const { return _threads[index].summary; }
+
+        private:
+            struct Thread
+            {
+                ThreadSummary summary;
+                std::vector<std::string> authors;
+
+                /* The authors joined into a list, as in the summary. */
+                std::string author_list;
+            };
+
+            void add_author(Thread & thread, const char * from);
+
+            StringPool & _pool;
+            std::vector<Thread> _threads;
+            std::unordered_map<std::string, size_t> _indices;
+    };
+}
+
+#endif
+
+// vim: fdm=syntax fo=croql et sw=4 sts=4 ts=8
+
@@ -0,0 +1,67 @@
+/* ner: notmuch/thread_summary.cc
+ *
+ * Copyright (c) 2013 Michael Forney
+ *
+ * This file is a part of ner.
+ *
+ * ner is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License version 3, as published by the Free
+ * Software Foundation.
+ *
+ * ner is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ner.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "thread_summary.hh"
+#include "tag_queue.hh"
+
+namespace Notmuch
+{
+    ThreadSummary::ThreadSummary()
+        : id(""), subject(""), authors(""), total_messages(0),
+            matched_messages(0)
+    {
+    }
+
+    ThreadSummary::ThreadSummary(notmuch_thread_t * thread, StringPool * pool)
+    {
+        /* Thread IDs are unique, so there is no point in looking them up. */
+        id = pool->store(notmuch_thread_get_thread_id(thread));
+        subject = pool->intern(notmuch_thread_get_subject(thread) ?: "");
+        authors = pool->intern(notmuch_thread_get_authors(thread) ?: "(null)");
+        date = std::chrono::system_clock::from_time_t(
+            notmuch_thread_get_newest_date(thread));
+        oldest_date = std::chrono::system_clock::from_time_t(
+            notmuch_thread_get_oldest_date(thread));
+        matched_messages = notmuch_thread_get_matched_messages(thread);
+        total_messages = notmuch_thread_get_total_messages(thread);
+
+        auto & dictionary = TagDictionary::instance();
+        notmuch_tags_t * notmuch_tags;
+        for (notmuch_tags = notmuch_thread_get_tags(thread);
+            notmuch_tags_valid(notmuch_tags);
+            notmuch_tags_move_to_next(notmuch_tags))
+        {
+            tags.insert(dictionary.id(notmuch_tags_get(notmuch_tags)));
+        }
+    }
+
+    void ThreadSummary::update_tags(const TagOperations & ops)
+    {
+        apply_tag_operations(tags, ops);
+    }
+
+    void ThreadSummary::perform_tag_operations(const TagOperations & ops)
+    {
+        update_tags(ops);
+        TagQueue::instance().enqueue(std::string("thread:") + id, ops);
+    }
+}
+
+// vim: fdm=syntax fo=croql et sw=4 sts=4 ts=8
+
@@ -0,0 +1,85 @@
+/* ner: notmuch/thread_summary.hh
+ *
+ * Copyright (c) 2013 Michael Forney
+ *
+ * This file is a part of ner.
+ *
+ * ner is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License version 3, as published by the Free
+ * Software Foundation.
+ *
+ * ner is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ner.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NER_NOTMUCH_THREAD_SUMMARY_H
+#define NER_NOTMUCH_THREAD_SUMMARY_H 1
+
+#include <chrono>
+#include <cstdint>
+#include <notmuch.h>
+
+#include "notmuch/util.hh"
+#include "notmuch/iterator.hh"
+#include "notmuch/string_pool.hh"
+#include "notmuch/tag_operations.hh"
+#include "notmuch/tag_set.hh"
+
+namespace Notmuch
+{
+    /**
+     * The metadata of a thread needed to list it.
+     *
+     * Unlike Thread, this is a small record of fixed size. Its strings live
+     * in a StringPool shared by all the summaries of a search, where authors
+     * and subjects that repeat across threads are stored only once.
+     */
+    struct ThreadSummary
+    {
+        /* Summaries are loaded into a string pool rather than by parts. */
+        typedef StringPool * Parts;
+
+        ThreadSummary();
+
+        /**
+         * Applies the tag operations to the summary's tags only.
+         */
+        void update_tags(const TagOperations & ops);
+
+        /**
+         * Applies the tag operations to the summary's tags, and queues them
+         * to be written to every message of the thread.
+         */
+        void perform_tag_operations(const TagOperations & ops);
+
+        const char * id;
+        const char * subject;
+        const char * authors;
+        TagSet tags;
+
+        /* The dates of the newest and oldest messages of the thread. */
+        std::chrono::system_clock::time_point date;
+        std::chrono::system_clock::time_point oldest_date;
+        uint32_t total_messages;
+        uint32_t matched_messages;
+
+        private:
+            ThreadSummary(notmuch_thread_t * thread, StringPool * pool);
+
+#if defined __GNUC__ && !__GNUC_PREREQ(4, 7)
+        friend class Iterator<ThreadSummary, notmuch_threads_t>;
+#else
+        friend ThreadSummaryIterator;
+#endif
+    };
+}
+
+#endif
+
+// vim: fdm=syntax fo=croql et sw=4 sts=4 ts=8
+
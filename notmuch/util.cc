@@ -34,8 +34,16 @@ namespace Notmuch
     DEFINE_POINTER_DESTROY(thread)
     DEFINE_POINTER_DESTROY(threads)
     DEFINE_POINTER_DESTROY(query)
+    DEFINE_POINTER_DESTROY(tags)
 
-    DEFINE_POINTER(database, notmuch_database_close)
+    /* notmuch_database_destroy returns a status, which we have no use for
+     * when cleaning up. */
+    static void destroy_database(notmuch_database_t * database)
+    {
+        notmuch_database_destroy(database);
+    }
+
+    DEFINE_POINTER(database, destroy_database)
 }
 
 // vim: fdm=syntax fo=croql et sw=4 sts=4 ts=8
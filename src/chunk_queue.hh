@@ -0,0 +1,107 @@
+/* ner: src/chunk_queue.hh
+ *
+ * Copyright (c) 2013 Michael Forney
+ *
+ * This file is a part of ner.
+ *
+ * ner is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License version 3, as published by the Free
+ * Software Foundation.
+ *
+ * ner is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ner.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NER_CHUNK_QUEUE_H
+#define NER_CHUNK_QUEUE_H 1
+
+#include <vector>
+#include <atomic>
+
+/**
+ * Passes chunks of items from one thread to another without locking.
+ *
+ * There may only be one thread pushing and one thread popping. The producer
+ * collects items into a chunk, and pushes the chunk once it is full, so the
+ * consumer can take all of them at once.
+ */
+template <typename T>
+class ChunkQueue
+{
+    public:
+        ChunkQueue()
+            : _head(new Chunk), _tail(_head)
+        {
+        }
+
+        ChunkQueue(const ChunkQueue & other) = delete;
+
+        ~ChunkQueue()
+        {
+            while (_head)
+            {
+                Chunk * next = _head->next.load(std::memory_order_relaxed);
+                delete _head;
+                _head = next;
+            }
+        }
+
+        /**
+         * Adds a chunk to the end of the queue. Only called by the producer.
+         */
+        void push(std::vector<T> && items)
+        {
+            Chunk * chunk = new Chunk;
+            chunk->items = std::move(items);
+
+            _tail->next.store(chunk, std::memory_order_release);
+            _tail = chunk;
+        }
+
+        /**
+         * Takes the chunk from the front of the queue. Only called by the
+         * consumer.
+         *
+         * \return Whether there was a chunk.
+         */
+        bool pop(std::vector<T> & items)
+        {
+            Chunk * next = _head->next.load(std::memory_order_acquire);
+
+            if (!next)
+                return false;
+
+            /* The first chunk has already been taken, and is only kept so
+             * that the producer always has a chunk to link to. */
+            items = std::move(next->items);
+            delete _head;
+            _head = next;
+
+            return true;
+        }
+
+    private:
+        struct Chunk
+        {
+            Chunk() : next(nullptr) {}
+
+            std::vector<T> items;
+            std::atomic<Chunk *> next;
+        };
+
+        /* Only used by the consumer. */
+        Chunk * _head;
+
+        /* Only used by the producer. */
+        Chunk * _tail;
+};
+
+#endif
+
+// vim: fdm=syntax fo=croql et sw=4 sts=4 ts=8
+
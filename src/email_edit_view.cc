@@ -29,6 +29,7 @@
 #include <sys/wait.h>
 
 #include "email_edit_view.hh"
+#include "key_map.hh"
 #include "view_manager.hh"
 #include "maildir.hh"
 #include "ner_config.hh"
@@ -46,12 +47,20 @@ EmailEditView::EmailEditView(const View::Geometry & geometry)
         "Subject"
     });
 
-    /* Key Sequences */
-    addHandledSequence("e", std::bind(&EmailEditView::edit, this));
-    addHandledSequence("a", std::bind(&EmailEditView::attach, this));
-    addHandledSequence("d", std::bind(&EmailEditView::removeSelectedAttachment, this));
-    addHandledSequence("y", std::bind(&EmailEditView::send, this));
-    addHandledSequence("f", std::bind(&EmailEditView::toggleSelectedPartFolding, this));
+    setKeyMap(keyMap());
+}
+
+const KeyMap & EmailEditView::keyMap()
+{
+    static const KeyMap keyMap("email_edit_view", {
+        { "edit",              { "e" },  KeyMap::bind(&EmailEditView::edit) },
+        { "attach",            { "a" },  KeyMap::bind(&EmailEditView::attach) },
+        { "remove_attachment", { "d" },  KeyMap::bind(&EmailEditView::removeSelectedAttachment) },
+        { "send",              { "y" },  KeyMap::bind(&EmailEditView::send) },
+        { "toggle_folding",    { "f" },  KeyMap::bind(&EmailEditView::toggleSelectedPartFolding) },
+    }, &LineBrowserView::keyMap());
+
+    return keyMap;
 }
 
 EmailEditView::~EmailEditView()
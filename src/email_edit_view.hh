@@ -62,6 +62,9 @@ class EmailEditView : public EmailView
 
         std::string _messageFile;
         const Identity * _identity;
+
+    private:
+        static const KeyMap & keyMap();
 };
 
 #endif
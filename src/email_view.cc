@@ -23,7 +23,6 @@
 #include "ncurses.hh"
 #include "util.hh"
 #include "status_bar.hh"
-#include "message_part_display_visitor.hh"
 #include "message_part_save_visitor.hh"
 
 const std::string lessMessage("[less]");
@@ -48,6 +47,7 @@ EmailView::~EmailView()
 void EmailView::setEmail(const std::string & filename)
 {
     _parts.clear();
+    _rows.clear();
 
     FILE * file = fopen(filename.c_str(), "r");
 
@@ -95,26 +95,37 @@ void EmailView::update()
 
     _partsEndLine.clear();
 
-    Renderer r(_window);
-
+    /* The headers are drawn in full each frame; doupdate only sends what
+     * changed. */
     for (auto & header : _visibleHeaders)
     {
-        if (r.off_screen())
+        if (row >= getmaxy(_window))
             return;
 
-        r << set_color(Color::EmailViewHeader) << header << ':';
-        r.skip(1);
-        r << set_color() << _headers[header];
+        Line line(_geometry.width);
+
+        line.add(header, Color::EmailViewHeader);
+        line.add(':', Color::EmailViewHeader);
+        line.skip(1);
+        line.add(_headers[header]);
 
-        r.add_cut_off_indicator();
-        r.next_line();
+        line.add_cut_off_indicator();
+        line.draw(_window, row++);
     }
 
-    whline(_window, 0, _geometry.width);
-    r.next_line();
+    if (row >= getmaxy(_window))
+        return;
+
+    mvwhline(_window, row++, 0, 0, _geometry.width);
 
-    MessagePartDisplayVisitor displayVisitor(_window, View::Geometry{ 0, r.row(),
-        _geometry.width, visibleLines() }, _offset, _selectedIndex);
+    int height = visibleLines();
+
+    /* When the message scrolls by a few lines, the rows below the headers are
+     * scrolled, and only the lines exposed are drawn. */
+    _rows.begin(_window, _offset, 0, row, height);
+
+    MessagePartDisplayVisitor displayVisitor(_rows, View::Geometry{ 0, 0,
+        _geometry.width, height }, _offset, _selectedIndex);
 
     for (auto & part : _parts)
     {
@@ -122,25 +133,35 @@ void EmailView::update()
         _partsEndLine.push_back(displayVisitor.lines());
     }
 
-    r.move(displayVisitor.row(), 0);
     _lineCount = displayVisitor.lines();
 
-    for (; !r.off_screen(); r.next_line())
-        r << styled('~', Color::EmptySpaceIndicator, A_BOLD);
+    for (int fill = displayVisitor.row(); fill < height; ++fill)
+    {
+        _rows.draw(fill, MessagePartDisplayVisitor::RowKey(-1, false), [](Line & line) {
+            line.add('~', Color::EmptySpaceIndicator, A_BOLD);
+        });
+    }
+
+    _rows.end(height);
 
-    r.set_color(Color::MoreLessIndicator);
+    /* The indicators are drawn over the rows, so those rows are drawn again
+     * in the next frame, in case the indicator has to go. */
+    wattron(_window, COLOR_PAIR(Color::MoreLessIndicator));
 
-    if (_offset > 0)
+    if (_offset > 0 && height > 0)
     {
-        r.move(_visibleHeaders.size() + 1, _geometry.width - lessMessage.size());
-        r << lessMessage;
+        mvwaddstr(_window, row, _geometry.width - lessMessage.size(), lessMessage.c_str());
+        _rows.invalidate(0);
     }
 
-    if (_offset + visibleLines() < _lineCount)
+    if (_offset + height < _lineCount && height > 0)
     {
-        r.move(getmaxy(_window) - 1, _geometry.width - moreMessage.size());
-        r << moreMessage;
+        mvwaddstr(_window, row + height - 1, _geometry.width - moreMessage.size(),
+            moreMessage.c_str());
+        _rows.invalidate(height - 1);
     }
+
+    wattroff(_window, COLOR_PAIR(Color::MoreLessIndicator));
 }
 
 EmailView::PartList::iterator EmailView::selectedPart()
@@ -164,15 +185,15 @@ void EmailView::toggleSelectedPartFolding()
     PartList::iterator part = selectedPart();
     (*part)->folded = !(*part)->folded;
 
+    /* The lines after the part moved. */
+    _rows.clear();
+
     if (part != _parts.begin())
         _selectedIndex = _partsEndLine[std::distance(_parts.begin(), part) - 1];
     else
         _selectedIndex = 0;
 
     makeSelectionVisible();
-
-    StatusBar::instance().update();
-    StatusBar::instance().refresh();
 }
 
 int EmailView::visibleLines() const
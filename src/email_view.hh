@@ -26,6 +26,7 @@
 
 #include "line_browser_view.hh"
 #include "message_part.hh"
+#include "message_part_display_visitor.hh"
 
 class EmailView : public LineBrowserView
 {
@@ -56,6 +57,9 @@ class EmailView : public LineBrowserView
 
         PartList _parts;
         std::vector<int> _partsEndLine;
+
+        /* The rows of the message below the headers. */
+        MessagePartDisplayVisitor::Rows _rows;
 };
 
 #endif
@@ -0,0 +1,178 @@
+/* ner: src/event_loop.cc
+ *
+ * Copyright (c) 2013 Michael Forney
+ *
+ * This file is a part of ner.
+ *
+ * ner is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License version 3, as published by the Free
+ * Software Foundation.
+ *
+ * ner is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ner.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <system_error>
+#include <vector>
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+#include "event_loop.hh"
+
+EventLoop * EventLoop::_instance = 0;
+int EventLoop::_signalPipe[2] = { -1, -1 };
+
+EventLoop & EventLoop::instance()
+{
+    return *_instance;
+}
+
+EventLoop::EventLoop()
+{
+    _wakeDescriptor = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    if (_wakeDescriptor == -1)
+        throw std::system_error(errno, std::system_category(), "eventfd");
+
+    if (pipe2(_signalPipe, O_NONBLOCK | O_CLOEXEC) == -1)
+    {
+        close(_wakeDescriptor);
+        throw std::system_error(errno, std::system_category(), "pipe");
+    }
+
+    _instance = this;
+}
+
+EventLoop::~EventLoop()
+{
+    for (auto & handler : _signalHandlers)
+        std::signal(handler.first, SIG_DFL);
+
+    close(_wakeDescriptor);
+    close(_signalPipe[0]);
+    close(_signalPipe[1]);
+
+    _signalPipe[0] = _signalPipe[1] = -1;
+    _instance = 0;
+}
+
+void EventLoop::wake()
+{
+    uint64_t count = 1;
+
+    /* If the counter is full, the loop is going to wake up anyway. */
+    while (write(_wakeDescriptor, &count, sizeof(count)) == -1 && errno == EINTR);
+}
+
+void EventLoop::handleSignal(int signal, const std::function<void ()> & handler)
+{
+    _signalHandlers[signal] = handler;
+
+    struct sigaction action = {};
+    action.sa_handler = &EventLoop::signalReceived;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+
+    sigaction(signal, &action, 0);
+}
+
+TimerWheel::Id EventLoop::addTimer(std::chrono::milliseconds delay,
+    const std::function<void ()> & callback)
+{
+    return _timers.add(delay, callback);
+}
+
+void EventLoop::cancelTimer(TimerWheel::Id id)
+{
+    _timers.cancel(id);
+}
+
+bool EventLoop::wait()
+{
+    int timeout = _timers.remaining();
+
+    struct pollfd descriptors[] = {
+        { STDIN_FILENO, POLLIN, 0 },
+        { _wakeDescriptor, POLLIN, 0 },
+        { _signalPipe[0], POLLIN, 0 }
+    };
+
+    if (poll(descriptors, 3, timeout) == -1)
+    {
+        if (errno != EINTR)
+            throw std::system_error(errno, std::system_category(), "poll");
+
+        /* A signal arrived; its byte is in the pipe by now. */
+        descriptors[0].revents = 0;
+        descriptors[1].revents = 0;
+        descriptors[2].revents = POLLIN;
+    }
+
+    if (descriptors[1].revents & POLLIN)
+    {
+        uint64_t count;
+        while (read(_wakeDescriptor, &count, sizeof(count)) == -1 && errno == EINTR);
+    }
+
+    if (descriptors[2].revents & POLLIN)
+        runSignalHandlers();
+
+    _timers.advance();
+
+    return descriptors[0].revents & (POLLIN | POLLHUP | POLLERR);
+}
+
+void EventLoop::signalReceived(int signal)
+{
+    int savedErrno = errno;
+    unsigned char number = signal;
+
+    /* Signals arriving while the pipe is full are dropped, which is fine,
+     * since the handlers only need to run once. */
+    ssize_t written = write(_signalPipe[1], &number, 1);
+    (void) written;
+
+    errno = savedErrno;
+}
+
+void EventLoop::runSignalHandlers()
+{
+    unsigned char numbers[64];
+    ssize_t count;
+    std::vector<int> signals;
+
+    while ((count = read(_signalPipe[0], numbers, sizeof(numbers))) > 0
+        || (count == -1 && errno == EINTR))
+    {
+        for (ssize_t index = 0; index < count; ++index)
+        {
+            /* Run the handler only once for a burst of the same signal, such
+             * as the resizes while a terminal is being dragged. */
+            if (std::find(signals.begin(), signals.end(), numbers[index]) == signals.end())
+                signals.push_back(numbers[index]);
+        }
+    }
+
+    for (int signal : signals)
+    {
+        auto handler = _signalHandlers.find(signal);
+
+        if (handler != _signalHandlers.end())
+            handler->second();
+    }
+}
+
+// vim: fdm=syntax fo=croql et sw=4 sts=4 ts=8
+
@@ -0,0 +1,99 @@
+/* ner: src/event_loop.hh
+ *
+ * Copyright (c) 2013 Michael Forney
+ *
+ * This file is a part of ner.
+ *
+ * ner is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License version 3, as published by the Free
+ * Software Foundation.
+ *
+ * ner is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ner.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef NER_EVENT_LOOP_H
+#define NER_EVENT_LOOP_H 1
+
+#include <map>
+#include <chrono>
+#include <functional>
+
+#include "timer_wheel.hh"
+
+/**
+ * Waits for input, along with everything else the UI reacts to.
+ *
+ * Background threads wake the loop up when they have something new to show,
+ * signals are passed on to the loop through a pipe, so that their handlers
+ * can use ncurses, and timers run callbacks on the loop after a delay. All
+ * delayed UI work should use these timers, rather than threads, so that
+ * ncurses is only used from one thread.
+ *
+ * This class is a singleton.
+ */
+class EventLoop
+{
+    public:
+        static EventLoop & instance();
+
+        EventLoop();
+        ~EventLoop();
+
+        /**
+         * Wakes up the loop, so that the screen gets redrawn.
+         *
+         * This can be called from any thread.
+         */
+        void wake();
+
+        /**
+         * Runs the handler on the loop whenever the signal is received.
+         */
+        void handleSignal(int signal, const std::function<void ()> & handler);
+
+        /**
+         * Runs the callback on the loop once the delay has passed.
+         */
+        TimerWheel::Id addTimer(std::chrono::milliseconds delay,
+            const std::function<void ()> & callback);
+
+        /**
+         * Cancels a timer, unless it already ran.
+         */
+        void cancelTimer(TimerWheel::Id id);
+
+        /**
+         * Waits until there is input, or something else happened. Signal
+         * handlers and expired timers are run before returning.
+         *
+         * \return Whether there is input to read.
+         */
+        bool wait();
+
+    private:
+        static void signalReceived(int signal);
+
+        void runSignalHandlers();
+
+        static EventLoop * _instance;
+
+        /* Written to by the signal handler, so it can't be a member. */
+        static int _signalPipe[2];
+
+        int _wakeDescriptor;
+
+        std::map<int, std::function<void ()>> _signalHandlers;
+        TimerWheel _timers;
+};
+
+#endif
+
+// vim: fdm=syntax fo=croql et sw=4 sts=4 ts=8
+
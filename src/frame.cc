@@ -0,0 +1,83 @@
+/* ner: src/frame.cc
+ *
+ * Copyright (c) 2013 Michael Forney
+ *
+ * This file is a part of ner.
+ *
+ * ner is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License version 3, as published by the Free
+ * Software Foundation.
+ *
+ * ner is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ner.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "frame.hh"
+#include "ncurses.hh"
+#include "view_manager.hh"
+#include "status_bar.hh"
+
+Frame * Frame::_instance = 0;
+
+Frame & Frame::instance()
+{
+    return *_instance;
+}
+
+Frame::Frame()
+    : _viewDirty(true), _statusDirty(true)
+{
+    _instance = this;
+}
+
+Frame::~Frame()
+{
+    _instance = 0;
+}
+
+void Frame::invalidate()
+{
+    _viewDirty = true;
+    _statusDirty = true;
+}
+
+void Frame::invalidateStatus()
+{
+    _statusDirty = true;
+}
+
+void Frame::draw()
+{
+    if (!_viewDirty && !_statusDirty)
+        return;
+
+    /* Updating the view may change the status, so it goes first. */
+    if (_viewDirty)
+    {
+        _viewDirty = false;
+
+        ViewManager::instance().update();
+        ViewManager::instance().refresh();
+    }
+
+    if (_statusDirty)
+    {
+        _statusDirty = false;
+
+        StatusBar::instance().update();
+    }
+
+    /* The status bar is staged after the view, so that it stays on top. */
+    StatusBar::instance().refresh();
+
+    doupdate();
+}
+
+// vim: fdm=syntax fo=croql et sw=4 sts=4 ts=8
+
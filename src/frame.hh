@@ -0,0 +1,68 @@
+/* ner: src/frame.hh
+ *
+ * Copyright (c) 2013 Michael Forney
+ *
+ * This file is a part of ner.
+ *
+ * ner is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License version 3, as published by the Free
+ * Software Foundation.
+ *
+ * ner is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ner.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef NER_FRAME_H
+#define NER_FRAME_H 1
+
+/**
+ * Collects changes to the screen, so that the terminal is updated once per
+ * frame.
+ *
+ * Rather than refreshing their windows right away, views and the status bar
+ * mark the frame dirty. Once the pending input has been handled, the main
+ * loop draws the frame: the dirty parts are updated, every window is staged
+ * with wnoutrefresh, and the terminal is updated with a single doupdate.
+ *
+ * This class is a singleton.
+ */
+class Frame
+{
+    public:
+        static Frame & instance();
+
+        Frame();
+        ~Frame();
+
+        /**
+         * Marks the active view and the status bar as changed.
+         */
+        void invalidate();
+
+        /**
+         * Marks only the status bar as changed.
+         */
+        void invalidateStatus();
+
+        /**
+         * Updates the terminal, if anything changed since the last frame.
+         */
+        void draw();
+
+    private:
+        static Frame * _instance;
+
+        bool _viewDirty;
+        bool _statusDirty;
+};
+
+#endif
+
+// vim: fdm=syntax fo=croql et sw=4 sts=4 ts=8
+
@@ -21,9 +21,8 @@
 #define NER_INPUT_HANDLER_H 1
 
 #include <vector>
-#include <map>
-#include <functional>
-#include <string>
+
+class KeyMap;
 
 /**
  * Accepts input sequences to perform different actions.
@@ -41,6 +40,7 @@ class InputHandler
             Handled
         };
 
+        InputHandler();
         virtual ~InputHandler() = 0;
 
         /**
@@ -62,29 +62,32 @@ class InputHandler
          */
         virtual HandleResult handleKeySequence(const std::vector<int> & sequence);
 
-    protected:
         /**
-         * Add a new sequence to the set of handled key sequences.
-         *
-         * Strings surrounded in angle braces will be interpreted with parseKey.
+         * Sets the count typed before the key sequences handled next, such as
+         * the 50 of "50j", or 0 if there was none.
+         */
+        static void setCount(unsigned count);
+
+        /**
+         * Returns the count typed before the key sequence being handled.
          *
-         * \param string The sequence of keys to handle
-         * \param function The function to execute when the sequence is executed
+         * \param fallback The value to return if there was no count.
          */
-        void addHandledSequence(const std::string & string, const std::function<void ()> & function);
+        static unsigned count(unsigned fallback = 1);
 
+    protected:
         /**
-         * Parses the special key into an integer for ncurses
+         * Sets the key sequences to handle.
          *
-         * Examples:
-         *   - "C-a"    : Control 'a'
-         *   - "Home"   : Home
-         *   - "S-Home" : Shift Home
+         * Each class of input handler compiles its key map once, so this
+         * should be given the one of the most derived class.
          */
-        int parseKey(const std::string & keyString) const;
+        void setKeyMap(const KeyMap & keyMap);
 
     private:
-        std::map<std::vector<int>, std::function<void ()>> _handledSequences;
+        static unsigned _count;
+
+        const KeyMap * _keyMap;
 };
 
 #endif
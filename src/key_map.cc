@@ -0,0 +1,197 @@
+/* ner: src/key_map.cc
+ *
+ * Copyright (c) 2013 Michael Forney
+ *
+ * This file is a part of ner.
+ *
+ * ner is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License version 3, as published by the Free
+ * Software Foundation.
+ *
+ * ner is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ner.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+
+#include "key_map.hh"
+#include "ner_config.hh"
+#include "ncurses.hh"
+
+KeyMap::KeyMap(const std::string & section, const std::vector<Binding> & bindings,
+    const KeyMap * base)
+{
+    if (base)
+    {
+        _nodes = base->_nodes;
+        _actions = base->_actions;
+    }
+    else
+        _nodes.push_back(Node{ {}, -1 });
+
+    auto & configured = NerConfig::instance().key_bindings;
+    auto sectionKeys = configured.find(section);
+
+    for (auto & binding : bindings)
+    {
+        const std::vector<std::string> * keys = &binding.keys;
+
+        if (sectionKeys != configured.end())
+        {
+            auto bindingKeys = sectionKeys->second.find(binding.name);
+
+            if (bindingKeys != sectionKeys->second.end())
+                keys = &bindingKeys->second;
+        }
+
+        for (auto & sequence : *keys)
+            insert(parseSequence(sequence), binding.action);
+    }
+}
+
+const KeyMap::Action * KeyMap::find(const std::vector<int> & sequence, bool & partial) const
+{
+    const Node * node = &_nodes.front();
+
+    for (int key : sequence)
+    {
+        auto child = std::lower_bound(node->children.begin(), node->children.end(),
+            std::make_pair(key, 0u));
+
+        if (child == node->children.end() || child->first != key)
+        {
+            partial = false;
+            return nullptr;
+        }
+
+        node = &_nodes[child->second];
+    }
+
+    partial = !node->children.empty();
+
+    return node->action >= 0 ? &_actions[node->action] : nullptr;
+}
+
+void KeyMap::insert(const std::vector<int> & sequence, const Action & action)
+{
+    unsigned index = 0;
+
+    for (int key : sequence)
+    {
+        auto & children = _nodes[index].children;
+        auto child = std::lower_bound(children.begin(), children.end(),
+            std::make_pair(key, 0u));
+
+        if (child != children.end() && child->first == key)
+            index = child->second;
+        else
+        {
+            unsigned next = _nodes.size();
+            children.insert(child, std::make_pair(key, next));
+
+            /* This may move the nodes, including the one children is in. */
+            _nodes.push_back(Node{ {}, -1 });
+            index = next;
+        }
+    }
+
+    /* A binding replaces whatever was bound to the same sequence. */
+    _nodes[index].action = _actions.size();
+    _actions.push_back(action);
+}
+
+std::vector<int> KeyMap::parseSequence(const std::string & keys)
+{
+    std::vector<int> sequence;
+
+    for (auto key = keys.begin(), e = keys.end(); key != e; ++key)
+    {
+        auto keyEnd = std::find(key, e, '>');
+
+        /* A '<' without a matching '>' is just a key. */
+        if (*key == '<' && keyEnd != e)
+        {
+            ++key;
+            sequence.push_back(parseKey(std::string(key, keyEnd)));
+            key = keyEnd;
+        }
+        else
+            sequence.push_back(*key);
+    }
+
+    return sequence;
+}
+
+int KeyMap::parseKey(const std::string & name)
+{
+    static const std::map<std::string, int> shiftedKeyMap = {
+        { "Delete",     KEY_SDC },
+        { "End",        KEY_SEND },
+        { "Home",       KEY_SHOME },
+        { "Left",       KEY_SLEFT },
+        { "Right",      KEY_SRIGHT },
+        { "Backspace",  KEY_BACKSPACE },
+    };
+
+    static const std::map<std::string, int> keyMap = {
+        { "Down",       KEY_DOWN },
+        { "Up",         KEY_UP },
+        { "Left",       KEY_LEFT },
+        { "Right",      KEY_RIGHT },
+        { "Home",       KEY_HOME },
+        { "Backspace",  KEY_BACKSPACE },
+        { "F1",         KEY_F(1) },
+        { "F2",         KEY_F(2) },
+        { "F3",         KEY_F(3) },
+        { "F4",         KEY_F(4) },
+        { "F5",         KEY_F(5) },
+        { "F6",         KEY_F(6) },
+        { "F7",         KEY_F(7) },
+        { "F8",         KEY_F(8) },
+        { "F9",         KEY_F(9) },
+        { "F10",        KEY_F(10) },
+        { "F11",        KEY_F(11) },
+        { "F12",        KEY_F(12) },
+        { "Delete",     KEY_DC },
+        { "Insert",     KEY_IC },
+        { "PageDown",   KEY_NPAGE },
+        { "PageUp",     KEY_PPAGE },
+        { "Enter",      KEY_ENTER },
+        { "BackTab",    KEY_BTAB },
+        { "End",        KEY_END },
+        { "Return",     '\n' },
+        { "Tab",        '\t' },
+        { "Space",      ' ' },
+    };
+
+    if (name.size() == 3 && name.substr(0, 2) == "C-")
+        return name[2] - 96;
+    else if (name.size() > 2 && name.substr(0, 2) == "S-")
+    {
+        auto key = shiftedKeyMap.find(name.substr(2));
+
+        if (key == shiftedKeyMap.end())
+            throw std::runtime_error("Unknown special key: " + name);
+        else
+            return key->second;
+    }
+    else
+    {
+        auto key = keyMap.find(name);
+
+        if (key == keyMap.end())
+            throw std::runtime_error("Unknown special key: " + name);
+        else
+            return key->second;
+    }
+}
+
+// vim: fdm=syntax fo=croql et sw=4 sts=4 ts=8
+
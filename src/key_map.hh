@@ -0,0 +1,129 @@
+/* ner: src/key_map.hh
+ *
+ * Copyright (c) 2013 Michael Forney
+ *
+ * This file is a part of ner.
+ *
+ * ner is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License version 3, as published by the Free
+ * Software Foundation.
+ *
+ * ner is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ner.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NER_KEY_MAP_H
+#define NER_KEY_MAP_H 1
+
+#include <vector>
+#include <string>
+#include <functional>
+
+class InputHandler;
+
+/**
+ * Maps key sequences to the actions of a class of input handlers.
+ *
+ * Each binding has a name, under which its keys can be configured in the keys
+ * section of ner.yaml, along with its default keys. The bindings are compiled
+ * once into a trie, which every handler of the class shares, so looking up a
+ * sequence takes one step per key.
+ *
+ * Key sequences are written as the keys themselves, with special keys in
+ * angle brackets, such as "gg", "<C-d>", or "<PageDown>".
+ */
+class KeyMap
+{
+    public:
+        typedef std::function<void (InputHandler &)> Action;
+
+        struct Binding
+        {
+            std::string name;
+            std::vector<std::string> keys;
+            Action action;
+        };
+
+        /**
+         * Compiles the bindings.
+         *
+         * \param section The name of the section of ner.yaml with the keys
+         *                for these bindings.
+         * \param base A key map whose bindings are included, such as the one
+         *             of the base class. Bindings given here replace those of
+         *             the base with the same keys.
+         */
+        KeyMap(const std::string & section, const std::vector<Binding> & bindings,
+            const KeyMap * base = nullptr);
+
+        /**
+         * Looks up a key sequence.
+         *
+         * \param partial Set to whether the sequence is the beginning of a
+         *                longer bound sequence.
+         * \return The action bound to the sequence, or nullptr.
+         */
+        const Action * find(const std::vector<int> & sequence, bool & partial) const;
+
+        /**
+         * Parses a key sequence, such as "gg" or "<C-d>".
+         */
+        static std::vector<int> parseSequence(const std::string & keys);
+
+        /**
+         * Parses the name of a special key into an integer for ncurses.
+         *
+         * Examples:
+         *   - "C-a"    : Control 'a'
+         *   - "Home"   : Home
+         *   - "S-Home" : Shift Home
+         */
+        static int parseKey(const std::string & name);
+
+        /**
+         * Makes an action calling a method of the handler.
+         */
+        template <typename T>
+        static Action bind(void (T::*method)())
+        {
+            return [method](InputHandler & handler) {
+                (static_cast<T &>(handler).*method)();
+            };
+        }
+
+        /**
+         * Makes an action calling a method of a member of the handler.
+         */
+        template <typename T, typename M, typename C>
+        static Action bind(M T::*member, void (C::*method)())
+        {
+            return [member, method](InputHandler & handler) {
+                ((static_cast<T &>(handler).*member).*method)();
+            };
+        }
+
+    private:
+        struct Node
+        {
+            /* The next node for each key, sorted by key. */
+            std::vector<std::pair<int, unsigned>> children;
+
+            /* The index of the action, or -1. */
+            int action;
+        };
+
+        void insert(const std::vector<int> & sequence, const Action & action);
+
+        std::vector<Node> _nodes;
+        std::vector<Action> _actions;
+};
+
+#endif
+
+// vim: fdm=syntax fo=croql et sw=4 sts=4 ts=8
+
@@ -18,30 +18,35 @@
  */
 
 #include <sstream>
+#include <algorithm>
 
 #include "line_browser_view.hh"
+#include "key_map.hh"
 #include "view_manager.hh"
+#include "frame.hh"
 
 LineBrowserView::LineBrowserView(const View::Geometry & geometry)
     : WindowView(geometry),
         _selectedIndex(0),
         _offset(0)
 {
-    /* Key Sequences */
-    addHandledSequence("j",          std::bind(&LineBrowserView::next, this));
-    addHandledSequence("<Down>",     std::bind(&LineBrowserView::next, this));
-    addHandledSequence("k",          std::bind(&LineBrowserView::previous, this));
-    addHandledSequence("<Up>",       std::bind(&LineBrowserView::previous, this));
-
-    addHandledSequence("<PageDown>", std::bind(&LineBrowserView::nextPage, this));
-    addHandledSequence("<C-d>",      std::bind(&LineBrowserView::nextPage, this));
-    addHandledSequence("<PageUp>",   std::bind(&LineBrowserView::previousPage, this));
-    addHandledSequence("<C-u>",      std::bind(&LineBrowserView::previousPage, this));
-
-    addHandledSequence("gg",         std::bind(&LineBrowserView::moveToTop, this));
-    addHandledSequence("<Home>",     std::bind(&LineBrowserView::moveToTop, this));
-    addHandledSequence("G",          std::bind(&LineBrowserView::moveToBottom, this));
-    addHandledSequence("<End>",      std::bind(&LineBrowserView::moveToBottom, this));
+    setKeyMap(keyMap());
+}
+
+const KeyMap & LineBrowserView::keyMap()
+{
+    static const KeyMap keyMap("line_browser", {
+        { "next",           { "j", "<Down>" },          KeyMap::bind(&LineBrowserView::next) },
+        { "previous",       { "k", "<Up>" },            KeyMap::bind(&LineBrowserView::previous) },
+
+        { "next_page",      { "<PageDown>", "<C-d>" },  KeyMap::bind(&LineBrowserView::nextPage) },
+        { "previous_page",  { "<PageUp>", "<C-u>" },    KeyMap::bind(&LineBrowserView::previousPage) },
+
+        { "top",            { "gg", "<Home>" },         KeyMap::bind(&LineBrowserView::moveToTop) },
+        { "bottom",         { "G", "<End>" },           KeyMap::bind(&LineBrowserView::moveToBottom) },
+    });
+
+    return keyMap;
 }
 
 void LineBrowserView::resize(const View::Geometry & geometry)
@@ -65,50 +70,46 @@ std::vector<std::string> LineBrowserView::status() const
 
 void LineBrowserView::next()
 {
-    if (_selectedIndex + 1 < lineCount())
-        ++_selectedIndex;
-
-    makeSelectionVisible();
+    moveBy(count());
 }
 
 void LineBrowserView::previous()
 {
-    if (_selectedIndex > 0)
-        --_selectedIndex;
-
-    makeSelectionVisible();
+    moveBy(-int(count()));
 }
 
 void LineBrowserView::nextPage()
 {
-    if (_selectedIndex + visibleLines() >= lineCount())
-        _selectedIndex = lineCount() - 1;
-    else
-        _selectedIndex += visibleLines() - 1;
-
-    makeSelectionVisible();
+    moveBy(count() * (visibleLines() - 1));
 }
 
 void LineBrowserView::previousPage()
 {
-    if (getmaxy(_window) > _selectedIndex)
-        _selectedIndex = 0;
-    else
-        _selectedIndex -= visibleLines() - 1;
-
-    makeSelectionVisible();
+    moveBy(-int(count()) * (visibleLines() - 1));
 }
 
 void LineBrowserView::moveToTop()
 {
-    _selectedIndex = 0;
-
-    makeSelectionVisible();
+    moveToLine(count(1) - 1);
 }
 
 void LineBrowserView::moveToBottom()
 {
-    _selectedIndex = lineCount() - 1;
+    /* With a count, go to that line, as in vi. */
+    if (count(0) > 0)
+        moveToLine(count(0) - 1);
+    else
+        moveToLine(lineCount() - 1);
+}
+
+void LineBrowserView::moveBy(int lines)
+{
+    moveToLine(_selectedIndex + lines);
+}
+
+void LineBrowserView::moveToLine(int line)
+{
+    _selectedIndex = std::max(std::min(line, lineCount() - 1), 0);
 
     makeSelectionVisible();
 }
@@ -120,8 +121,7 @@ void LineBrowserView::makeSelectionVisible()
     else if (_selectedIndex >= _offset + visibleLines())
         _offset = _selectedIndex - visibleLines() + 1;
 
-    StatusBar::instance().update();
-    StatusBar::instance().refresh();
+    Frame::instance().invalidateStatus();
 }
 
 int LineBrowserView::visibleLines() const
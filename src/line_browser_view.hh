@@ -35,36 +35,43 @@ class LineBrowserView : public WindowView
         virtual std::vector<std::string> status() const;
 
         /**
-         * Advances the cursor to the next line.
+         * Advances the cursor to the next line, or by the count typed before
+         * the key.
          */
         virtual void next();
 
         /**
-         * Moves the cursor back to the previous line.
+         * Moves the cursor back to the previous line, or by the count.
          */
         virtual void previous();
 
         /**
-         * Moves the cursor down one page.
+         * Moves the cursor down one page, or by the count of pages.
          */
         virtual void nextPage();
 
         /**
-         * Moves the cursor up one page.
+         * Moves the cursor up one page, or by the count of pages.
          */
         virtual void previousPage();
 
         /**
-         * Moves the cursor to the first line
+         * Moves the cursor to the first line, or to the line of the count.
          */
         virtual void moveToTop();
 
         /**
-         * Moves the cursor to the last line
+         * Moves the cursor to the last line, or to the line of the count.
          */
         virtual void moveToBottom();
 
     protected:
+        /**
+         * Returns the key sequences every line browser handles, for the key
+         * maps of derived classes to include.
+         */
+        static const KeyMap & keyMap();
+
         /**
          * Returns the number of lines visible on the screen.
          *
@@ -94,6 +101,17 @@ class LineBrowserView : public WindowView
          */
         virtual void makeSelectionVisible();
 
+        /**
+         * Moves the cursor by some lines, down for positive amounts, stopping
+         * at the first and last line.
+         */
+        void moveBy(int lines);
+
+        /**
+         * Moves the cursor to the given line, or the closest one.
+         */
+        void moveToLine(int line);
+
         int _offset;
         int _selectedIndex;
 };
@@ -21,16 +21,20 @@
 #include <iostream>
 #include <fstream>
 #include <locale>
-#include <csignal>
 #include <unistd.h>
 #include <gmime/gmime.h>
 
 #include "ner.hh"
+#include "event_loop.hh"
 #include "view_manager.hh"
 #include "search_list_view.hh"
 #include "identity_manager.hh"
 #include "ner_config.hh"
 #include "notmuch/config.hh"
+#include "notmuch/database_pool.hh"
+#include "notmuch/tag_queue.hh"
+#include "notmuch/tag_set.hh"
+#include "notmuch/count_cache.hh"
 
 void terminate()
 {
@@ -38,26 +42,6 @@ void terminate()
     g_mime_shutdown();
 }
 
-void resize(int arg)
-{
-    endwin();
-    refresh();
-
-    ViewManager::instance().resize();
-    StatusBar::instance().resize();
-
-    refresh();
-
-    ViewManager::instance().update();
-    StatusBar::instance().update();
-
-    ViewManager::instance().refresh();
-    StatusBar::instance().refresh();
-
-    /* Clear the -1 character */
-    getch();
-}
-
 int main(int argc, char * argv[])
 {
     std::locale::global(std::locale(""));
@@ -70,17 +54,22 @@ int main(int argc, char * argv[])
     Notmuch::Config notmuch_config;
     notmuch_config.load();
 
+    EventLoop event_loop;
+
+    Notmuch::DatabasePool database_pool;
+    Notmuch::TagDictionary tag_dictionary;
+    Notmuch::TagQueue tag_queue;
+    Notmuch::CountCache count_cache;
+
+    /* Show finished writes and counts as soon as they are done. */
+    tag_queue.set_change_listener(std::bind(&EventLoop::wake, &event_loop));
+    count_cache.set_change_listener(std::bind(&EventLoop::wake, &event_loop));
+
     NerConfig config;
     config.load();
 
     NCurses::initialize(config.color_map);
 
-    std::signal(SIGWINCH, &resize);
-
-    /* Refresh the view every minute (or when the user presses a key). */
-    if (config.refresh_view)
-        timeout(60000);
-
     Ner ner;
 
     std::shared_ptr<View> searchListView(new SearchListView());
@@ -90,6 +79,12 @@ int main(int argc, char * argv[])
 
     NCurses::cleanup();
 
+    if (tag_queue.pending() > 0)
+    {
+        std::cerr << "ner: " << tag_queue.pending()
+            << " tag changes could not be written" << std::endl;
+    }
+
     g_mime_shutdown();
 
     return EXIT_SUCCESS;
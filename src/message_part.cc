@@ -33,11 +33,44 @@ MessagePart::MessagePart(const std::string & id_)
 }
 
 TextPart::TextPart(GMimePart * part)
-    : MessagePart(g_mime_part_get_content_id(part) ? : std::string())
+    : MessagePart(g_mime_part_get_content_id(part) ? : std::string()), _part(part)
 {
     GMimeContentType * mimeContentType = g_mime_object_get_content_type(GMIME_OBJECT(part));
     contentType = g_mime_content_type_to_string(mimeContentType);
 
+    if (!g_mime_content_type_is_type(mimeContentType, "text", "*"))
+    {
+        /* We don't know how to handle this part */
+        throw std::runtime_error(std::string("Cannot handle content type: ") +
+            contentType);
+    }
+
+    g_object_ref(_part);
+}
+
+TextPart::~TextPart()
+{
+    if (_part)
+        g_object_unref(_part);
+}
+
+const std::vector<std::string> & TextPart::lines() const
+{
+    if (_part)
+    {
+        decode();
+
+        /* The part isn't needed anymore. */
+        g_object_unref(_part);
+        _part = nullptr;
+    }
+
+    return _lines;
+}
+
+void TextPart::decode() const
+{
+    GMimeContentType * mimeContentType = g_mime_object_get_content_type(GMIME_OBJECT(_part));
     GMimeStream * contentStream = NULL;
 
     /* If this part is html text */
@@ -49,7 +82,7 @@ TextPart::TextPart(GMimePart * part)
         pipe(readPipes);
         pipe(writePipes);
 
-        GMimeDataWrapper * content = g_mime_part_get_content_object(part);
+        GMimeDataWrapper * content = g_mime_part_get_content_object(_part);
 
         if (pid_t pid = fork())
         {
@@ -78,11 +111,11 @@ TextPart::TextPart(GMimePart * part)
             exit(0);
         }
     }
-    /* If this part is text */
-    else if (g_mime_content_type_is_type(mimeContentType, "text", "*"))
+    /* Otherwise, this part is some other text */
+    else
     {
-        GMimeDataWrapper * content = g_mime_part_get_content_object(part);
-        const char * charset = g_mime_object_get_content_type_parameter(GMIME_OBJECT(part), "charset");
+        GMimeDataWrapper * content = g_mime_part_get_content_object(_part);
+        const char * charset = g_mime_object_get_content_type_parameter(GMIME_OBJECT(_part), "charset");
         GMimeStream * stream = g_mime_data_wrapper_get_stream(content);
 
         GMimeStream * filteredStream = g_mime_stream_filter_new(stream);
@@ -102,14 +135,6 @@ TextPart::TextPart(GMimePart * part)
 
         contentStream = filteredStream;
     }
-    else
-    {
-        /* We don't know how to handle this part */
-    }
-
-    if (contentStream == NULL)
-        throw std::runtime_error(std::string("Cannot handle content type: ") +
-            contentType);
 
     GMimeIOStream stream(contentStream);
     g_object_unref(contentStream);
@@ -120,7 +145,7 @@ TextPart::TextPart(GMimePart * part)
         std::getline(stream, line);
         for (std::size_t tab = 0; (tab = line.find('\t', tab)) != std::string::npos; ++tab)
             line.replace(tab, 1, 8 - (tab % 8), ' ');
-        lines.push_back(line);
+        _lines.push_back(line);
     }
 }
 
@@ -39,14 +39,31 @@ struct MessagePart
     std::string id;
 };
 
+/**
+ * A text part, which is only decoded once its lines are needed, such as when
+ * it is unfolded. Until then, it keeps a reference to its MIME part.
+ */
 struct TextPart : public MessagePart
 {
     TextPart(GMimePart * part);
+    TextPart(const TextPart & other) = delete;
+    ~TextPart();
 
     virtual void accept(MessagePartVisitor & visitor);
 
-    std::vector<std::string> lines;
+    /**
+     * Returns the lines of the part, decoding it first if it wasn't yet.
+     * HTML parts are converted with the html command.
+     */
+    const std::vector<std::string> & lines() const;
+
     std::string contentType;
+
+    private:
+        void decode() const;
+
+        mutable GMimePart * _part;
+        mutable std::vector<std::string> _lines;
 };
 
 struct Attachment : public MessagePart
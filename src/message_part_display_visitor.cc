@@ -17,7 +17,7 @@
  * ner.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include <sstream>
+#include <string>
 
 #include "message_part_display_visitor.hh"
 #include "colors.hh"
@@ -27,43 +27,41 @@
 
 const int wrapWidth(80);
 
-MessagePartDisplayVisitor::MessagePartDisplayVisitor(WINDOW * window,
+MessagePartDisplayVisitor::MessagePartDisplayVisitor(Rows & rows,
     const View::Geometry & area, int offset, int selection)
-    : _renderer(window, false), _area(area), _offset(offset), _messageRow(0),
+    : _rows(rows), _area(area), _row(0), _offset(offset), _messageRow(0),
         _selection(selection)
 {
-    _renderer.move(area.y, 0);
 }
 
 void MessagePartDisplayVisitor::visit(const TextPart & part)
 {
     using namespace NCurses;
 
-    Renderer & r = _renderer;
-
-    if (_messageRow >= _offset && r.row() < _area.y + _area.height)
+    if (_messageRow >= _offset && _row < _area.height)
     {
         bool selected = _messageRow == _selection;
 
-        r << styled(part.folded ? '+' : '-', Color::AttachmentFilename, A_BOLD);
-        r.skip(1);
-
-        r.set_line_attributes(selected ? A_REVERSE : 0);
-        r << "Text Part: " << styled(part.contentType, Color::AttachmentMimeType)
-            << clear_attr;
+        _rows.draw(_row++, RowKey(_messageRow, selected), [&](Line & line) {
+            line.add(part.folded ? '+' : '-', Color::AttachmentFilename, A_BOLD);
+            line.skip(1);
 
-        r.next_line();
+            line.set_line_attributes(selected ? A_REVERSE : 0);
+            line.add("Text Part: ");
+            line.add(part.contentType, Color::AttachmentMimeType);
+        });
     }
 
     ++_messageRow;
 
+    /* Folded parts are not decoded. */
     if (part.folded)
         return;
 
-    for (auto & line : part.lines)
+    for (auto & text : part.lines())
     {
         unsigned citationLevel = 0;
-        for (auto c : line)
+        for (auto c : text)
         {
             if (c == '>')
                 ++citationLevel;
@@ -83,26 +81,27 @@ void MessagePartDisplayVisitor::visit(const TextPart & part)
             }
         }
 
-        for (auto lineWrapper = LineWrapper(line, _area.width - 2); !lineWrapper.done(); ++_messageRow)
+        for (auto lineWrapper = LineWrapper(text, _area.width - 2); !lineWrapper.done(); ++_messageRow)
         {
             bool selected = _messageRow == _selection;
             bool wrapped = lineWrapper.wrapped();
 
             std::string wrappedLine(lineWrapper.next());
 
-            if (_messageRow < _offset || r.row() >= _area.y + _area.height)
+            if (_messageRow < _offset || _row >= _area.height)
                 continue;
 
-            if (wrapped)
-                r << styled(ch(ACS_CKBOARD), Color::LineWrapIndicator);
+            _rows.draw(_row++, RowKey(_messageRow, selected), [&](Line & line) {
+                if (wrapped)
+                    line.add_acs(ACS_CKBOARD, Color::LineWrapIndicator);
 
-            r.advance(2);
+                line.advance(2);
 
-            r.set_line_attributes(selected ? A_REVERSE : 0);
+                line.set_line_attributes(selected ? A_REVERSE : 0);
 
-            r << styled(wrappedLine, color) << clear_attr;
-            r.add_cut_off_indicator();
-            r.next_line();
+                line.add(wrappedLine, color);
+                line.add_cut_off_indicator();
+            });
         }
     }
 }
@@ -111,33 +110,33 @@ void MessagePartDisplayVisitor::visit(const Attachment & part)
 {
     using namespace NCurses;
 
-    Renderer & r = _renderer;
-
-    if (_messageRow >= _offset && r.row() < _area.y + _area.height)
+    if (_messageRow >= _offset && _row < _area.height)
     {
         bool selected = _messageRow == _selection;
 
-        r << styled('*', Color::AttachmentFilename, A_BOLD);
-        r.skip(1);
+        _rows.draw(_row++, RowKey(_messageRow, selected), [&](Line & line) {
+            line.add('*', Color::AttachmentFilename, A_BOLD);
+            line.skip(1);
 
-        if (selected)
-            r.set_line_attributes(A_REVERSE);
+            if (selected)
+                line.set_line_attributes(A_REVERSE);
 
-        r << "Attachment: " << set_color(Color::AttachmentFilename) << part.filename;
-        r.skip(1);
-        r << set_color(Color::AttachmentMimeType) << part.contentType;
-        r.skip(1);
-        r << set_color(Color::AttachmentFilesize) << part.filesize;
+            line.add("Attachment: ");
+            line.add(part.filename, Color::AttachmentFilename);
+            line.skip(1);
+            line.add(part.contentType, Color::AttachmentMimeType);
+            line.skip(1);
+            line.add(std::to_string(part.filesize), Color::AttachmentFilesize);
 
-        r.add_cut_off_indicator();
-        r.next_line();
+            line.add_cut_off_indicator();
+        });
         ++_messageRow;
     }
 }
 
 int MessagePartDisplayVisitor::row() const
 {
-    return _renderer.row();
+    return _row;
 }
 
 int MessagePartDisplayVisitor::lines() const
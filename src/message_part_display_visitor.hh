@@ -20,14 +20,25 @@
 #ifndef NER_MESSAGE_PART_DISPLAY_VISITOR_H
 #define NER_MESSAGE_PART_DISPLAY_VISITOR_H 1
 
+#include <utility>
+
 #include "message_part_visitor.hh"
 #include "ncurses.hh"
+#include "row_cache.hh"
 #include "view.hh"
 
 class MessagePartDisplayVisitor : public MessagePartVisitor
 {
     public:
-        MessagePartDisplayVisitor(WINDOW * window, const View::Geometry & area,
+        /* The line of the message a row shows, and whether it is selected. */
+        typedef std::pair<int, bool> RowKey;
+        typedef RowCache<RowKey> Rows;
+
+        /**
+         * \param area The size of the region of rows to draw to; its
+         *             position is given to the rows when they begin.
+         */
+        MessagePartDisplayVisitor(Rows & rows, const View::Geometry & area,
             int offset, int selection);
 
         virtual void visit(const TextPart & part);
@@ -37,10 +48,13 @@ class MessagePartDisplayVisitor : public MessagePartVisitor
         int lines() const;
 
     private:
-        NCurses::Renderer _renderer;
+        Rows & _rows;
         View::Geometry _area;
-        int _messageRow;
+
+        /* The row of the region the next line goes to. */
+        int _row;
         int _offset;
+        int _messageRow;
         int _selection;
 };
 
@@ -33,7 +33,8 @@ template <class OutputIterator>
 
         virtual void visit(const TextPart & part)
         {
-            _iterator = std::copy(part.lines.begin(), part.lines.end(), _iterator);
+            auto & lines = part.lines();
+            _iterator = std::copy(lines.begin(), lines.end(), _iterator);
         }
 
         virtual void visit(const Attachment & part)
@@ -25,7 +25,7 @@
 #include "ncurses.hh"
 #include "status_bar.hh"
 
-#include "notmuch/database.hh"
+#include "notmuch/database_pool.hh"
 #include "notmuch/thread.hh"
 
 using namespace Notmuch;
@@ -41,9 +41,9 @@ MessageView::~MessageView()
 
 void MessageView::setMessage(const std::string & id)
 {
-    Database database;
+    auto database = DatabasePool::instance().reader();
 
-    Message message = database.find_message(id);
+    Message message = database->find_message(id, Message::FilenamePart);
     setEmail(message.filename);
 }
 
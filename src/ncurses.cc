@@ -18,6 +18,8 @@
  */
 
 #include <cassert>
+#include <cwchar>
+#include <unordered_map>
 
 #include "ncurses.hh"
 
@@ -195,6 +197,271 @@ namespace NCurses
             clear();
     }
 
+    int character_width(wchar_t c)
+    {
+        /* Characters of the basic multilingual plane are looked up in a
+         * table, and the others, which are rare, in a map. */
+        const signed char unknown = -2;
+        static std::vector<signed char> widths(0x10000, unknown);
+        static std::unordered_map<wchar_t, int> other_widths;
+
+        if (c >= 0 && c < 0x10000)
+        {
+            signed char & width = widths[c];
+
+            if (width == unknown)
+                width = wcwidth(c);
+
+            return width;
+        }
+
+        auto width = other_widths.find(c);
+
+        if (width == other_widths.end())
+            width = other_widths.insert(std::make_pair(c, wcwidth(c))).first;
+
+        return width->second;
+    }
+
+    Line::Line(int width, attr_t attributes)
+        : _width(std::max(width, 0)), _filled(0), _column(0), _anchor(0), _limit(_width),
+            _attributes(attributes), _cut_off(false)
+    {
+        _cells.reserve(_width);
+        _widths.reserve(_width);
+    }
+
+    void Line::set_line_attributes(attr_t attributes)
+    {
+        _attributes = attributes;
+    }
+
+    void Line::set_max_width(size_t width)
+    {
+        _limit = width > _width - std::min(_column, _width) ? _width : _column + width;
+    }
+
+    void Line::add(const char * text, size_t length, Color color, attr_t attributes)
+    {
+        if (_cut_off)
+            return;
+
+        pad(_column);
+
+        const char * end = text + length;
+        cchar_t ascii = cell(L" ", color, attributes);
+        std::mbstate_t state = std::mbstate_t();
+
+        /* The cell of the last spacing character, which combining characters
+         * are added to. */
+        int last = -1;
+
+        while (text < end)
+        {
+            wchar_t c;
+            int width;
+
+            /* Runs of ASCII characters need no conversion. */
+            if (static_cast<unsigned char>(*text) < 0x80)
+            {
+                c = *text++;
+                width = c >= 0x20 && c < 0x7f ? 1 : -1;
+            }
+            else
+            {
+                size_t bytes = std::mbrtowc(&c, text, end - text, &state);
+
+                /* Stop at invalid or incomplete characters. */
+                if (bytes == size_t(-1) || bytes == size_t(-2))
+                    break;
+
+                text += bytes;
+                width = character_width(c);
+            }
+
+            /* Stop at characters which can't be displayed. */
+            if (width < 0)
+                break;
+
+            if (width == 0)
+            {
+                /* A combining character goes in the cell of the previous
+                 * character, or a blank if there is none. */
+                if (last == -1)
+                {
+                    if (_column + 1 > _limit)
+                    {
+                        _cut_off = _limit == _width;
+                        break;
+                    }
+
+                    last = _cells.size();
+                    push(ascii, 1);
+                }
+
+                wchar_t * characters = _cells[last].chars;
+                int position = std::find(characters, characters + CCHARW_MAX, L'\0')
+                    - characters;
+
+                if (position < CCHARW_MAX - 1)
+                    characters[position] = c;
+
+                continue;
+            }
+
+            if (_column + width > _limit)
+            {
+                _cut_off = _limit == _width;
+                break;
+            }
+
+            last = _cells.size();
+
+            if (width == 1 && c < 0x80)
+            {
+                ascii.chars[0] = c;
+                push(ascii, 1);
+            }
+            else
+            {
+                wchar_t characters[] = { c, L'\0' };
+                push(cell(characters, color, attributes), width);
+            }
+        }
+    }
+
+    void Line::add(const std::string & text, Color color, attr_t attributes)
+    {
+        add(text.data(), text.size(), color, attributes);
+    }
+
+    void Line::add(const char * text, Color color, attr_t attributes)
+    {
+        add(text, std::strlen(text), color, attributes);
+    }
+
+    void Line::add(char c, Color color, attr_t attributes)
+    {
+        add(&c, 1, color, attributes);
+    }
+
+    void Line::add_number(unsigned long number, Color color, attr_t attributes)
+    {
+        char digits[24];
+        int length = snprintf(digits, sizeof(digits), "%lu", number);
+
+        add(digits, length, color, attributes);
+    }
+
+    void Line::add_acs(chtype c, Color color, attr_t attributes)
+    {
+        if (_cut_off)
+            return;
+
+        pad(_column);
+
+        if (_column + 1 > _limit)
+        {
+            _cut_off = _limit == _width;
+            return;
+        }
+
+        wchar_t characters[] = { static_cast<wchar_t>(chchar(c)), L'\0' };
+        push(cell(characters, color, attributes | chattr(c) | A_ALTCHARSET), 1);
+    }
+
+    void Line::advance(size_t amount)
+    {
+        if (_cut_off)
+            return;
+
+        _anchor += amount;
+
+        if (_anchor >= _width)
+        {
+            _cut_off = true;
+            return;
+        }
+
+        /* Output which went past the new column is overwritten. */
+        if (_anchor < _filled)
+            truncate(_anchor);
+
+        _column = _anchor;
+    }
+
+    void Line::skip(size_t amount)
+    {
+        if (_cut_off)
+            return;
+
+        if (amount > _limit - std::min(_column, _limit))
+            _cut_off = true;
+        else
+            _column += amount;
+    }
+
+    void Line::add_cut_off_indicator()
+    {
+        if (!_cut_off || _width == 0)
+            return;
+
+        truncate(_width - 1);
+        pad(_width - 1);
+
+        push(cell(L"$", Color::CutOffIndicator, 0), 1);
+    }
+
+    void Line::draw(WINDOW * window, int row)
+    {
+        pad(_width);
+
+        mvwadd_wchnstr(window, row, 0, _cells.data(), _cells.size());
+    }
+
+    cchar_t Line::cell(const wchar_t * characters, Color color, attr_t attributes) const
+    {
+        cchar_t cell;
+        setcchar(&cell, characters, _attributes | attributes, color, NULL);
+
+        return cell;
+    }
+
+    void Line::push(const cchar_t & cell, int width)
+    {
+        _cells.push_back(cell);
+        _widths.push_back(width);
+        _filled += width;
+        _column = _filled;
+    }
+
+    void Line::pad(size_t column)
+    {
+        if (_filled >= column)
+            return;
+
+        cchar_t blank = cell(L" ", Color::None, 0);
+
+        for (; _filled < column; ++_filled)
+        {
+            _cells.push_back(blank);
+            _widths.push_back(1);
+        }
+    }
+
+    void Line::truncate(size_t column)
+    {
+        size_t filled = 0;
+        size_t cells = 0;
+
+        for (; cells < _widths.size() && filled + _widths[cells] <= column; ++cells)
+            filled += _widths[cells];
+
+        _cells.resize(cells);
+        _widths.resize(cells);
+        _filled = _column = filled;
+    }
+
     std::ios_base & acs(std::ios_base & ios)
     {
         void * pointer = ios.pword(state_index);
@@ -27,6 +27,7 @@
 #include <locale>
 #include <vector>
 #include <iostream>
+#include <string>
 #include <cstring>
 
 #if HAVE_NCURSESW_NCURSES_H
@@ -271,6 +272,108 @@ namespace NCurses
             int _row;
     };
 
+    /**
+     * Builds a line of the window directly as complex characters.
+     *
+     * Unlike Renderer, this does not go through a stream: each piece of text
+     * is added with its style, runs of ASCII characters are copied into cells
+     * without any conversion, and the width of other characters is only
+     * looked up once. The line always covers the full width, so drawing it
+     * replaces whatever was on that row of the window.
+     */
+    class Line
+    {
+        public:
+            Line(int width = 0, attr_t attributes = 0);
+
+            /**
+             * Sets the attributes of the rest of the line, including the
+             * blank space.
+             */
+            void set_line_attributes(attr_t attributes);
+
+            /**
+             * Limits the width of the following output, starting at the
+             * current column. Output past the limit is dropped silently.
+             */
+            void set_max_width(size_t width = std::numeric_limits<size_t>::max());
+
+            void add(const char * text, size_t length, Color color = Color::None,
+                attr_t attributes = 0);
+            void add(const std::string & text, Color color = Color::None,
+                attr_t attributes = 0);
+            void add(const char * text, Color color = Color::None, attr_t attributes = 0);
+            void add(char c, Color color = Color::None, attr_t attributes = 0);
+            void add_number(unsigned long number, Color color = Color::None,
+                attr_t attributes = 0);
+
+            /**
+             * Adds a character of the alternate character set, such as the
+             * ACS_* characters.
+             */
+            void add_acs(chtype c, Color color = Color::None, attr_t attributes = 0);
+
+            /**
+             * Moves some columns from the last movement (call to advance) or
+             * the start of the line.
+             */
+            void advance(size_t amount);
+
+            /**
+             * Skips some columns from the end of the last output.
+             */
+            void skip(size_t amount = 1);
+
+            /**
+             * Whether some output did not fit on the line.
+             */
+            bool cut_off() const { return _cut_off; }
+
+            /**
+             * Replaces the rightmost column with a cut off indicator if some
+             * output did not fit on the line.
+             */
+            void add_cut_off_indicator();
+
+            /**
+             * Draws the line at the given row of the window.
+             */
+            void draw(WINDOW * window, int row);
+
+        private:
+            /**
+             * Returns a cell with the current style, for the characters to
+             * be filled in.
+             */
+            cchar_t cell(const wchar_t * characters, Color color, attr_t attributes) const;
+
+            void push(const cchar_t & cell, int width);
+            void pad(size_t column);
+            void truncate(size_t column);
+
+            std::vector<cchar_t> _cells;
+
+            /* The number of columns taken by each cell. */
+            std::vector<unsigned char> _widths;
+
+            size_t _width;
+
+            /* The columns covered by cells so far, and where the next output
+             * goes, which may be past them. */
+            size_t _filled;
+            size_t _column;
+            size_t _anchor;
+            size_t _limit;
+            attr_t _attributes;
+            bool _cut_off;
+    };
+
+    /**
+     * Returns the number of columns the character takes, or -1 if it is not
+     * printable.
+     */
+    int character_width(wchar_t c);
+
     /* State Manipulators */
     struct SetColor { Color color; };
     struct EnableAttr { attr_t attributes; };
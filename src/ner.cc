@@ -18,11 +18,14 @@
  */
 
 #include <iostream>
+#include <algorithm>
 #include <sys/types.h>
 #include <signal.h>
 #include <unistd.h>
 
 #include "ner.hh"
+#include "event_loop.hh"
+#include "key_map.hh"
 #include "ncurses.h"
 #include "util.hh"
 #include "status_bar.hh"
@@ -34,22 +37,42 @@
 #include "compose_view.hh"
 #include "colors.hh"
 #include "line_editor.hh"
+#include "ner_config.hh"
 
 #include "notmuch/exception.hh"
+#include "notmuch/tag_queue.hh"
 
 using namespace Notmuch;
 
+/* Larger counts are not useful, and could overflow. */
+const unsigned maximumCount = 100000;
+
 Ner::Ner()
+    /* Refresh the view every minute (or when the user presses a key). */
+    : _refreshDelay(NerConfig::instance().refresh_view ? 60000 : -1)
 {
-    /* Key Sequences */
-    addHandledSequence("Q",     std::bind(&Ner::quit, this));
-    addHandledSequence("s",     std::bind(&Ner::search, this));
-    addHandledSequence("m",     std::bind(&Ner::compose, this));
-    addHandledSequence("M",     std::bind(&Ner::openMessage, this));
-    addHandledSequence("T",     std::bind(&Ner::openThread, this));
-    addHandledSequence(";",     std::bind(&Ner::openViewView, this));
-    addHandledSequence("<C-l>", std::bind(&Ner::redraw, this));
-    addHandledSequence("<C-z>", std::bind(&kill, getpid(), SIGTSTP));
+    setKeyMap(keyMap());
+
+    EventLoop::instance().handleSignal(SIGWINCH, std::bind(&Ner::resize, this));
+
+    if (_refreshDelay >= 0)
+        scheduleRefresh();
+}
+
+const KeyMap & Ner::keyMap()
+{
+    static const KeyMap keyMap("global", {
+        { "quit",           { "Q" },        KeyMap::bind(&Ner::quit) },
+        { "search",         { "s" },        KeyMap::bind(&Ner::search) },
+        { "compose",        { "m" },        KeyMap::bind(&Ner::compose) },
+        { "open_message",   { "M" },        KeyMap::bind(&Ner::openMessage) },
+        { "open_thread",    { "T" },        KeyMap::bind(&Ner::openThread) },
+        { "views",          { ";" },        KeyMap::bind(&Ner::openViewView) },
+        { "redraw",         { "<C-l>" },    KeyMap::bind(&Ner::redraw) },
+        { "suspend",        { "<C-z>" },    [](InputHandler &) { kill(getpid(), SIGTSTP); } },
+    });
+
+    return keyMap;
 }
 
 Ner::~Ner()
@@ -59,23 +82,56 @@ Ner::~Ner()
 void Ner::run()
 {
     std::vector<int> sequence;
+    unsigned count = 0;
+
+    _frame.invalidate();
 
     _running = true;
     while (_running)
     {
-        _viewManager.update();
-        _viewManager.refresh();
-
+        /* ncurses may have read more input than it returned, so check for
+         * input before waiting for the terminal. */
+        timeout(0);
         int key = getch();
+        timeout(-1);
+
+        if (key == ERR)
+        {
+            /* Draw once all the input so far has been handled. */
+            _frame.draw();
+
+            /* Anything else that wakes up the loop means something new to
+             * show, such as pending writes in the status bar. */
+            if (!EventLoop::instance().wait())
+                _frame.invalidate();
+
+            continue;
+        }
+
+        _frame.invalidate();
+
+        if (key == KEY_RESIZE)
+            continue;
 
         if (key == KEY_BACKSPACE && sequence.size() > 0)
             sequence.pop_back();
+        else if (key == KEY_BACKSPACE)
+            count /= 10;
         else if (key == ctrl('c'))
+        {
             sequence.clear();
+            count = 0;
+        }
+        /* Digits before a key sequence are a count, as in vi. A leading zero
+         * is not. */
+        else if (sequence.empty() && key >= '0' && key <= '9' && (key != '0' || count > 0))
+            count = std::min(count * 10 + (key - '0'), maximumCount);
         else
         {
             sequence.push_back(key);
 
+            InputHandler::setCount(count);
+
             auto handleResult = handleKeySequence(sequence);
 
             /* If Ner handled the input sequence */
@@ -93,9 +149,23 @@ void Ner::run()
                         handleResult == InputHandler::HandleResult::NoMatch))
                     sequence.clear();
             }
+
+            InputHandler::setCount(0);
+
+            if (sequence.empty())
+                count = 0;
         }
     }
 
+    /* Write any tag changes that are still queued, while the views are still
+     * around to draw the message. */
+    if (TagQueue::instance().pending() > 0)
+    {
+        StatusBar::instance().displayMessage("Writing pending tag changes...");
+        _frame.draw();
+        TagQueue::instance().flush(std::chrono::seconds(30));
+    }
+
     _viewManager.close_all_views();
 }
 
@@ -169,13 +239,32 @@ void Ner::openViewView()
     _viewManager.addView(std::make_shared<ViewView>());
 }
 
-void Ner::redraw()
+void Ner::resize()
 {
-    clear();
+    endwin();
     refresh();
 
-    _statusBar.update();
-    _statusBar.refresh();
+    _viewManager.resize();
+    _statusBar.resize();
+
+    refresh();
+
+    _frame.invalidate();
+}
+
+void Ner::scheduleRefresh()
+{
+    /* Redraw the view every so often, even without any input, so that
+     * relative dates stay correct. */
+    EventLoop::instance().addTimer(std::chrono::milliseconds(_refreshDelay),
+        std::bind(&Ner::scheduleRefresh, this));
+}
+
+void Ner::redraw()
+{
+    /* Repaint the whole terminal with the next frame. */
+    clearok(curscr, TRUE);
+    _frame.invalidate();
 }
 
 // vim: fdm=syntax fo=croql et sw=4 sts=4 ts=8
@@ -26,6 +26,7 @@
 #include "input_handler.hh"
 #include "view_manager.hh"
 #include "status_bar.hh"
+#include "frame.hh"
 
 class Ner : public InputHandler
 {
@@ -43,13 +44,24 @@ class Ner : public InputHandler
         void openViewView();
         void redraw();
 
+        /**
+         * Lays out the screen again after the terminal was resized.
+         */
+        void resize();
+
         inline ViewManager & viewManager()
         {
             return _viewManager;
         }
 
     private:
+        static const KeyMap & keyMap();
+
+        void scheduleRefresh();
+
         bool _running;
+        int _refreshDelay;
+        Frame _frame;
         ViewManager _viewManager;
         StatusBar _statusBar;
 };
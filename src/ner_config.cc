@@ -62,6 +62,18 @@ struct convert<Search>
     {
         search.name = node["name"].as<std::string>();
         search.query = node["query"].as<std::string>();
+        search.engine = Notmuch::ThreadEngine::Threads;
+
+        if (auto engine = node["engine"])
+        {
+            std::string engineStr = engine.as<std::string>();
+
+            if (engineStr == "messages")
+                search.engine = Notmuch::ThreadEngine::Messages;
+            else if (engineStr != "threads")
+                return false;
+        }
+
         return true;
     }
 };
@@ -85,6 +97,7 @@ void NerConfig::load()
     /* Reset configuration to default values. */
     sort_mode = Notmuch::SortMode::NewestFirst;
     refresh_view = true;
+    search_window = 1000;
     add_signature_dashes = true;
     commands = {
         { "send",   "/usr/sbin/sendmail -t" },
@@ -92,6 +105,7 @@ void NerConfig::load()
         { "html",   "elinks -dump" }
     };
     color_map = defaultColorMap;
+    key_bindings.clear();
 
     std::string configPath(std::string(getenv("HOME")) + "/" + nerConfigFile);
     YAML::Node document = YAML::LoadFile(configPath);
@@ -130,6 +144,9 @@ void NerConfig::load()
             if (auto refreshViewNode = general["refresh_view"])
                 refresh_view = refreshViewNode.as<bool>();
 
+            if (auto searchWindowNode = general["search_window"])
+                search_window = searchWindowNode.as<unsigned>();
+
             if (auto addSigDashesNode = general["add_sig_dashes"])
                 add_signature_dashes = addSigDashesNode.as<bool>();
         }
@@ -143,9 +160,9 @@ void NerConfig::load()
             searches = searches_node.as<decltype(searches)>();
         else
             searches = {
-                { "New", "tag:inbox and tag:unread" },
-                { "Unread", "tag:unread" },
-                { "Inbox", "tag:inbox" }
+                { "New", "tag:inbox and tag:unread", Notmuch::ThreadEngine::Threads },
+                { "Unread", "tag:unread", Notmuch::ThreadEngine::Threads },
+                { "Inbox", "tag:inbox", Notmuch::ThreadEngine::Threads }
             };
 
         /* Colors */
@@ -205,6 +222,25 @@ void NerConfig::load()
             for (auto name = colors.begin(), e = colors.end(); name != e; ++name)
                 color_map[colorNames.at(name->first.as<std::string>())] = name->second.as<ColorPair>();
         }
+
+        /* Keys */
+        if (auto keys = document["keys"])
+        {
+            for (auto section = keys.begin(), e = keys.end(); section != e; ++section)
+            {
+                auto & bindings = key_bindings[section->first.as<std::string>()];
+
+                for (auto binding = section->second.begin(), e = section->second.end();
+                    binding != e; ++binding)
+                {
+                    /* A binding has either a single sequence or a list of them. */
+                    if (binding->second.IsSequence())
+                        bindings[binding->first.as<std::string>()] = binding->second.as<std::vector<std::string>>();
+                    else
+                        bindings[binding->first.as<std::string>()] = { binding->second.as<std::string>() };
+                }
+            }
+        }
     }
 }
 
@@ -37,9 +37,13 @@ class NerConfig
         std::vector<Search> searches;
         Notmuch::SortMode sort_mode;
         bool refresh_view;
+        unsigned search_window;
         bool add_signature_dashes;
         ColorMap color_map;
 
+        /* The keys of each binding, by section and name of the binding. */
+        std::map<std::string, std::map<std::string, std::vector<std::string>>> key_bindings;
+
     private:
         NerConfig();
 
@@ -0,0 +1,159 @@
+/* ner: src/relative_time.cc
+ *
+ * Copyright (c) 2013 Michael Forney
+ *
+ * This file is a part of ner.
+ *
+ * ner is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License version 3, as published by the Free
+ * Software Foundation.
+ *
+ * ner is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ner.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+
+#include "relative_time.hh"
+
+const time_t minute = 60;
+const time_t hour = 60 * minute;
+const time_t day = 24 * hour;
+
+/* Every time zone's offset is a multiple of 15 minutes, so the local day
+ * doesn't change within a quarter of an hour. */
+const time_t quarterHour = 15 * minute;
+
+/* Forget the older dates if there are too many of them. */
+const size_t maximumDays = 4096;
+
+RelativeTime::RelativeTime()
+    : _now(0), _tomorrow(0)
+{
+}
+
+void RelativeTime::setTime(time_t now)
+{
+    _now = now;
+
+    if (_now >= _tomorrow || _now < _midnights[0])
+    {
+        computeDays();
+        _days.clear();
+    }
+}
+
+const char * RelativeTime::format(time_t time)
+{
+    if (time > _now)
+        return "the future";
+
+    time_t difference = _now - time;
+
+    if (difference > 180 * day)
+        return formatDay(time, true);
+    else if (difference < hour)
+    {
+        snprintf(_buffer, sizeof(_buffer), "%ld mins. ago", long(difference / minute));
+        return _buffer;
+    }
+    else if (difference < week * day)
+    {
+        int index = 0;
+
+        while (index < week && time < _midnights[index])
+            ++index;
+
+        /* Daylight saving time starts or ends on this day. */
+        if (time < _midnights[index] || !_uniform[index])
+            return formatLocal(time, index == 0 ? "Today %R" : index == 1 ? "Yest. %R" : "%a. %R");
+
+        time_t seconds = time - _midnights[index];
+
+        snprintf(_buffer, sizeof(_buffer), "%s %02ld:%02ld", _dayNames[index],
+            long(seconds / hour), long(seconds % hour / minute));
+        return _buffer;
+    }
+    else
+        return formatDay(time, false);
+}
+
+const char * RelativeTime::format(const std::chrono::system_clock::time_point & time)
+{
+    return format(std::chrono::system_clock::to_time_t(time));
+}
+
+void RelativeTime::computeDays()
+{
+    struct tm now;
+    localtime_r(&_now, &now);
+
+    long offsets[week + 1];
+    long tomorrowOffset;
+
+    for (int index = -1; index <= week; ++index)
+    {
+        struct tm date = now;
+
+        date.tm_mday -= index;
+        date.tm_hour = 0;
+        date.tm_min = 0;
+        date.tm_sec = 0;
+        date.tm_isdst = -1;
+
+        time_t midnight = mktime(&date);
+
+        if (index == -1)
+        {
+            _tomorrow = midnight;
+            tomorrowOffset = date.tm_gmtoff;
+            continue;
+        }
+
+        _midnights[index] = midnight;
+        offsets[index] = date.tm_gmtoff;
+
+        if (index == 0)
+            snprintf(_dayNames[index], sizeof(_dayNames[index]), "Today");
+        else if (index == 1)
+            snprintf(_dayNames[index], sizeof(_dayNames[index]), "Yest.");
+        else
+            strftime(_dayNames[index], sizeof(_dayNames[index]), "%a.", &date);
+    }
+
+    for (int index = 0; index <= week; ++index)
+        _uniform[index] = offsets[index] == (index == 0 ? tomorrowOffset : offsets[index - 1]);
+}
+
+const char * RelativeTime::formatDay(time_t time, bool withYear)
+{
+    time_t key = (time / quarterHour) * 2 + withYear;
+    auto date = _days.find(key);
+
+    if (date == _days.end())
+    {
+        if (_days.size() >= maximumDays)
+            _days.clear();
+
+        date = _days.insert({ key, formatLocal(time, withYear ? "%F" : "%B %d") }).first;
+    }
+
+    return date->second.c_str();
+}
+
+const char * RelativeTime::formatLocal(time_t time, const char * format)
+{
+    struct tm local;
+    localtime_r(&time, &local);
+
+    strftime(_buffer, sizeof(_buffer), format, &local);
+    return _buffer;
+}
+
+// vim: fdm=syntax fo=croql et sw=4 sts=4 ts=8
+
@@ -0,0 +1,85 @@
+/* ner: src/relative_time.hh
+ *
+ * Copyright (c) 2013 Michael Forney
+ *
+ * This file is a part of ner.
+ *
+ * ner is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License version 3, as published by the Free
+ * Software Foundation.
+ *
+ * ner is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ner.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NER_RELATIVE_TIME_H
+#define NER_RELATIVE_TIME_H 1
+
+#include <string>
+#include <chrono>
+#include <unordered_map>
+#include <ctime>
+
+/**
+ * Formats dates relative to the current time, such as "5 mins. ago" or
+ * "Yest. 14:02".
+ *
+ * The local midnights of the last week are computed when the day changes,
+ * so that dates within the week are formatted with integer arithmetic.
+ * Older dates only depend on their day, and are converted to local time once
+ * for each quarter of an hour they fall in, until the day changes.
+ */
+class RelativeTime
+{
+    public:
+        RelativeTime();
+
+        /**
+         * Sets the time to format dates relative to, usually the current
+         * time.
+         */
+        void setTime(time_t now);
+
+        /**
+         * Formats a date.
+         *
+         * \return The formatted date, valid until the next call.
+         */
+        const char * format(time_t time);
+        const char * format(const std::chrono::system_clock::time_point & time);
+
+    private:
+        /* The number of days with their own name. */
+        static const int week = 7;
+
+        void computeDays();
+        const char * formatDay(time_t time, bool withYear);
+        const char * formatLocal(time_t time, const char * format);
+
+        time_t _now;
+
+        /* The local midnight of today and of each day of the last week. */
+        time_t _midnights[week + 1];
+        time_t _tomorrow;
+
+        /* Whether each day has the same UTC offset throughout. */
+        bool _uniform[week + 1];
+
+        /* The names of the days, such as "Today", "Yest." or "Mon.". */
+        char _dayNames[week + 1][16];
+
+        /* Older dates, by quarter of an hour. */
+        std::unordered_map<time_t, std::string> _days;
+
+        char _buffer[32];
+};
+
+#endif
+
+// vim: fdm=syntax fo=croql et sw=4 sts=4 ts=8
+
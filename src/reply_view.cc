@@ -26,7 +26,7 @@
 #include "util.hh"
 #include "message_part_text_visitor.hh"
 
-#include "notmuch/database.hh"
+#include "notmuch/database_pool.hh"
 #include "notmuch/message.hh"
 
 using namespace Notmuch;
@@ -34,9 +34,8 @@ using namespace Notmuch;
 ReplyView::ReplyView(const std::string & id, const View::Geometry & geometry)
     : EmailEditView(geometry)
 {
-    Database database;
-    Message message = database.find_message(id);
-    database.close();
+    Message message = DatabasePool::instance().reader()->find_message(id,
+        Message::FilenamePart);
 
     FILE * messageFile = fopen(message.filename.c_str(), "r");
     GMimeStream * stream = g_mime_stream_file_new(messageFile);
@@ -0,0 +1,233 @@
+/* ner: src/row_cache.hh
+ *
+ * Copyright (c) 2013 Michael Forney
+ *
+ * This file is a part of ner.
+ *
+ * ner is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License version 3, as published by the Free
+ * Software Foundation.
+ *
+ * ner is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ner.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef NER_ROW_CACHE_H
+#define NER_ROW_CACHE_H 1
+
+#include <vector>
+#include <algorithm>
+
+#include "ncurses.hh"
+
+/**
+ * Remembers the lines a list view drew into its window, so that each frame
+ * only formats and draws the lines which changed.
+ *
+ * Each row is stored along with a key describing what it shows, including
+ * whether it is selected. Rows whose key did not change are left alone, so
+ * moving the selection only draws two rows. When the view scrolls by less
+ * than a screen, the window is scrolled with wscrl, and with idlok set, the
+ * terminal can scroll its lines too, so only the exposed rows are drawn.
+ * Other lines which moved to another row are drawn again without being
+ * formatted.
+ *
+ * The rows may be limited to a region of the window. The view's window must
+ * not be erased between frames.
+ */
+template <typename Key>
+class RowCache
+{
+    public:
+        RowCache()
+            : _window(nullptr), _width(0), _top(0), _first(0), _epoch(0)
+        {
+        }
+
+        /**
+         * Starts a frame. Every row is drawn again if the window or region
+         * was resized, or the epoch changed, for example because the lines
+         * show relative dates.
+         *
+         * \param first The index of the item shown in the first row, which
+         *              tells how far the view scrolled.
+         * \param top The first row of the region, in the window.
+         * \param height The number of rows of the region, or -1 for the rest
+         *               of the window.
+         */
+        void begin(WINDOW * window, size_t first, long epoch = 0, int top = 0,
+            int height = -1)
+        {
+            if (height < 0)
+                height = getmaxy(window) - top;
+
+            height = std::max(height, 0);
+
+            if (window != _window || getmaxx(window) != _width || top != _top
+                || height != int(_rows.size()) || epoch != _epoch)
+            {
+                clear();
+
+                /* Let the terminal insert and delete lines when scrolling. */
+                idlok(window, TRUE);
+            }
+
+            _window = window;
+            _width = getmaxx(window);
+            _top = top;
+            _epoch = epoch;
+
+            if (!_rows.empty() && first != _first)
+                shift(long(first) - long(_first));
+
+            _first = first;
+
+            _previous.swap(_rows);
+            _previous.resize(height);
+            _rows.assign(height, Row());
+        }
+
+        /**
+         * Draws the line for the key at the given row, calling format to
+         * build it, unless it is already known.
+         */
+        template <typename Format>
+        void draw(int row, const Key & key, Format format)
+        {
+            if (row < 0 || row >= int(_rows.size()))
+                return;
+
+            Row & previous = _previous[row];
+
+            /* The row still shows the same thing. */
+            if (previous.state == Row::Drawn && previous.key == key)
+            {
+                _rows[row] = std::move(previous);
+                previous.state = Row::Unknown;
+                return;
+            }
+
+            Row & current = _rows[row];
+            current.state = Row::Drawn;
+            current.key = key;
+
+            auto moved = std::find_if(_previous.begin(), _previous.end(),
+                [&key](const Row & other) {
+                    return other.state == Row::Drawn && other.key == key;
+                });
+
+            if (moved != _previous.end())
+                current.line = moved->line;
+            else
+            {
+                current.line = NCurses::Line(_width);
+                format(current.line);
+            }
+
+            current.line.draw(_window, _top + row);
+        }
+
+        /**
+         * Ends a frame, clearing the rows from the given one to the bottom of
+         * the window.
+         */
+        void end(int row)
+        {
+            for (row = std::max(row, 0); row < int(_rows.size()); ++row)
+            {
+                if (_previous[row].state != Row::Blank)
+                {
+                    wmove(_window, _top + row, 0);
+                    wclrtoeol(_window);
+                }
+
+                _rows[row].state = Row::Blank;
+            }
+
+            _previous.clear();
+        }
+
+        /**
+         * Draws the row again in the next frame, for example because
+         * something else was drawn over it.
+         */
+        void invalidate(int row)
+        {
+            if (row >= 0 && row < int(_rows.size()))
+                _rows[row].state = Row::Unknown;
+        }
+
+        /**
+         * Forgets what was drawn, so that every row is drawn again.
+         */
+        void clear()
+        {
+            _rows.clear();
+        }
+
+    private:
+        struct Row
+        {
+            enum State { Unknown, Blank, Drawn };
+
+            Row(State state = Unknown) : state(state) {}
+
+            State state;
+            Key key;
+            NCurses::Line line;
+        };
+
+        /**
+         * Scrolls the region by some rows, up for positive amounts.
+         */
+        void shift(long amount)
+        {
+            long height = _rows.size();
+
+            if (amount >= height || -amount >= height)
+            {
+                clear();
+                return;
+            }
+
+            /* Scrolling is only enabled for as long as it takes, so that
+             * writing to the bottom right corner doesn't scroll. */
+            wsetscrreg(_window, _top, _top + height - 1);
+            scrollok(_window, TRUE);
+            wscrl(_window, amount);
+            scrollok(_window, FALSE);
+            wsetscrreg(_window, 0, getmaxy(_window) - 1);
+
+            /* The rows scrolled into view are blank. */
+            if (amount > 0)
+            {
+                std::move(_rows.begin() + amount, _rows.end(), _rows.begin());
+                std::fill(_rows.end() - amount, _rows.end(), Row(Row::Blank));
+            }
+            else
+            {
+                std::move_backward(_rows.begin(), _rows.end() + amount, _rows.end());
+                std::fill(_rows.begin(), _rows.begin() - amount, Row(Row::Blank));
+            }
+        }
+
+        WINDOW * _window;
+        int _width;
+        int _top;
+        size_t _first;
+        long _epoch;
+
+        std::vector<Row> _rows;
+        std::vector<Row> _previous;
+};
+
+#endif
+
+// vim: fdm=syntax fo=croql et sw=4 sts=4 ts=8
+
@@ -20,11 +20,14 @@
 #include <sstream>
 
 #include "search_list_view.hh"
+#include "key_map.hh"
 #include "view_manager.hh"
 #include "search_view.hh"
 #include "ncurses.hh"
 #include "ner_config.hh"
 
+#include "notmuch/count_cache.hh"
+
 using namespace Notmuch;
 
 const int searchNameWidth = 15;
@@ -34,8 +37,16 @@ SearchListView::SearchListView(const View::Geometry & geometry)
     : LineBrowserView(geometry),
         _searches(NerConfig::instance().searches)
 {
-    /* Key Sequences */
-    addHandledSequence("\n", std::bind(&SearchListView::openSelectedSearch, this));
+    setKeyMap(keyMap());
+}
+
+const KeyMap & SearchListView::keyMap()
+{
+    static const KeyMap keyMap("search_list_view", {
+        { "open", { "\n" },  KeyMap::bind(&SearchListView::openSelectedSearch) },
+    }, &LineBrowserView::keyMap());
+
+    return keyMap;
 }
 
 SearchListView::~SearchListView()
@@ -47,7 +58,8 @@ void SearchListView::update()
     using namespace NCurses;
 
     Renderer r(_window);
-    Notmuch::Database database;
+    auto & count_cache = CountCache::instance();
+    std::vector<std::string> visible;
 
     if (_offset > _searches.size())
         return;
@@ -70,11 +82,26 @@ void SearchListView::update()
         r.advance(searchTermsWidth);
 
         /* Number of Results */
-        Notmuch::Query query(search->query, &database);
-        r << set_color(Color::SearchListViewResults) << query.count_messages() << " results";
+        CountCache::Counts counts;
+        r.set_color(Color::SearchListViewResults);
+
+        if (count_cache.counts(search->query, counts))
+        {
+            r << counts.total << " results";
+
+            if (counts.unread > 0)
+                r << ", " << counts.unread << " unread";
+        }
+        else
+            r << "...";
 
         r.add_cut_off_indicator();
+
+        visible.push_back(search->query);
     }
+
+    /* Counts are only redone if the database changed. */
+    count_cache.refresh(visible);
 }
 
 std::vector<std::string> SearchListView::status() const
@@ -97,8 +124,10 @@ int SearchListView::lineCount() const
 
 void SearchListView::openSelectedSearch()
 {
-    ViewManager::instance().addView(std::make_shared<SearchView>(
-        _searches.at(_selectedIndex).query));
+    const Search & search = _searches.at(_selectedIndex);
+
+    ViewManager::instance().addView(std::make_shared<SearchView>(search.query,
+        search.engine));
 }
 
 // vim: fdm=syntax fo=croql et sw=4 sts=4 ts=8
@@ -24,10 +24,13 @@
 
 #include "line_browser_view.hh"
 
+#include "notmuch/thread_grouper.hh"
+
 struct Search
 {
     std::string name;
     std::string query;
+    Notmuch::ThreadEngine engine;
 };
 
 class SearchListView : public LineBrowserView
@@ -46,6 +49,8 @@ class SearchListView : public LineBrowserView
         virtual int lineCount() const;
 
     private:
+        static const KeyMap & keyMap();
+
         std::vector<Search> _searches;
 };
 
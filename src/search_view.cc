@@ -22,17 +22,27 @@
 #include <algorithm>
 #include <chrono>
 #include <iterator>
-#include <sched.h>
+#include <set>
+#include <map>
+#include <unordered_map>
+#include <limits>
+#include <ctime>
 
 #include "search_view.hh"
+#include "key_map.hh"
 #include "thread_message_view.hh"
 #include "view_manager.hh"
 #include "util.hh"
 #include "colors.hh"
 #include "ncurses.hh"
 #include "status_bar.hh"
+#include "event_loop.hh"
+#include "frame.hh"
 
 #include "notmuch/query.hh"
+#include "notmuch/database_pool.hh"
+#include "notmuch/tag_queue.hh"
+#include "notmuch/sharded_query.hh"
 #include "notmuch/exception.hh"
 
 using namespace Notmuch;
@@ -41,93 +51,142 @@ const int newestDateWidth = 13;
 const int messageCountWidth = 8;
 const int authorsWidth = 20;
 
-const auto conditionWaitTime = std::chrono::milliseconds(50);
+/* Collected threads are handed to the view in chunks of this many threads,
+ * or whatever was collected in this time. */
+const size_t chunkSize = 256;
+const auto publishInterval = std::chrono::milliseconds(20);
 
-SearchView::SearchView(const std::string & search, const View::Geometry & geometry)
+/* The most date ranges a search is split into. */
+const unsigned maximumSlices = 4;
+
+/* With more changed threads than this, collecting the results again is
+ * cheaper than updating them one by one. */
+const unsigned maximumChangedThreads = 500;
+
+/* The shortest date range loaded at a time. */
+const time_t minimumSpan = 24 * 60 * 60;
+
+SearchView::SearchView(const std::string & search, ThreadEngine engine,
+    const View::Geometry & geometry)
     : LineBrowserView(geometry),
-        _searchTerms(search)
+        _searchTerms(search), _engine(engine),
+        _searchWindow(NerConfig::instance().search_window), _collectLimit(0),
+        _screenLines(0),
+        _pool(new StringPool), _refreshing(false), _revision(0),
+        _windowed(false), _windowBegin(0), _windowEnd(0), _oldestDate(0), _newestDate(0),
+        _span(0)
 {
+    updateCollectLimit();
+
     _collecting = true;
     _thread = std::thread(std::bind(&SearchView::collectThreads, this));
 
-    /* Key Sequences */
-    addHandledSequence("=", std::bind(&SearchView::refreshThreads, this));
-    addHandledSequence("\n", std::bind(&SearchView::openSelectedThread, this));
+    setKeyMap(keyMap());
+}
 
-    std::unique_lock<std::mutex> lock(_mutex);
-    while (_threads.size() < getmaxy(_window) && _collecting)
-        _condition.wait_for(lock, conditionWaitTime);
+const KeyMap & SearchView::keyMap()
+{
+    static const KeyMap keyMap("search_view", {
+        { "refresh",      { "=" },   KeyMap::bind(&SearchView::refreshThreads) },
+        { "open",         { "\n" },  KeyMap::bind(&SearchView::openSelectedThread) },
+        { "tag",          { "+" },   KeyMap::bind(&SearchView::tagSelectedThread) },
+        { "tag_all",      { "*" },   KeyMap::bind(&SearchView::tagAllResults) },
+        { "jump_to_date", { "d" },   KeyMap::bind(&SearchView::jumpToDate) },
+    }, &LineBrowserView::keyMap());
+
+    return keyMap;
 }
 
 SearchView::~SearchView()
 {
-    if (_thread.joinable())
-    {
-        _collecting = false;
-        _thread.join();
-    }
+    stopCollecting();
 }
 
 void SearchView::update()
 {
     using namespace NCurses;
 
-    Renderer r(_window);
+    if (adoptThreads())
+        makeSelectionVisible();
 
-    if (_offset > _threads.size())
-        return;
+    /* The selection may have moved, or the screen been resized, and a
+     * window may need more threads once the last ones are loaded. */
+    fillWindow();
+
+    TagId unread_id = TagDictionary::instance().unread();
+
+    time_t now = time(NULL);
+    _relativeTime.setTime(now);
 
-    for (auto thread = _threads.begin() + _offset, e = _threads.end();
-        thread != e && !r.off_screen(); ++thread, r.next_line())
+    /* Relative dates change once a minute. */
+    _rows.begin(_window, _offset, now / 60);
+
+    int row = 0;
+
+    for (size_t index = _offset; index < _threads.size() && row < visibleLines();
+        ++index, ++row)
     {
-        bool selected = r.row() + _offset == _selectedIndex;
-        bool unread = thread->tags.find("unread") != thread->tags.end();
-        bool completeMatch = thread->matched_messages == thread->total_messages;
+        const ThreadSummary & thread = _threads[index];
+        bool selected = index == _selectedIndex;
 
-        attr_t attributes = 0;
+        _rows.draw(row, RowKey(thread, selected), [&](Line & line) {
+            bool unread = thread.tags.contains(unread_id);
+            bool completeMatch = thread.matched_messages == thread.total_messages;
 
-        if (unread)
-            attributes |= A_BOLD;
+            attr_t attributes = 0;
 
-        if (selected)
-            attributes |= A_REVERSE;
+            if (unread)
+                attributes |= A_BOLD;
 
-        r.set_line_attributes(attributes);
+            if (selected)
+                attributes |= A_REVERSE;
 
-        /* Date */
-        r.set_max_width(newestDateWidth - 1);
-        r << styled(relative_time(thread->date), Color::SearchViewDate);
-        r.advance(newestDateWidth);
+            line.set_line_attributes(attributes);
 
-        /* Message Count */
-        Color message_count_color = completeMatch
-            ? Color::SearchViewMessageCountComplete
-            : Color::SearchViewMessageCountPartial;
-        r.set_max_width(messageCountWidth - 1);
-        r << set_color() << '[' << set_color(message_count_color)
-            << thread->matched_messages << '/' << thread->total_messages
-            << set_color() << ']';
-        r.advance(messageCountWidth);
+            /* Date */
+            line.set_max_width(newestDateWidth - 1);
+            line.add(_relativeTime.format(thread.date), Color::SearchViewDate);
+            line.advance(newestDateWidth);
 
-        /* Authors */
-        r.set_max_width(authorsWidth - 1);
-        r << styled(thread->authors, Color::SearchViewAuthors);
-        r.advance(authorsWidth);
+            /* Message Count */
+            Color message_count_color = completeMatch
+                ? Color::SearchViewMessageCountComplete
+                : Color::SearchViewMessageCountPartial;
+            line.set_max_width(messageCountWidth - 1);
+            line.add('[');
+            line.add_number(thread.matched_messages, message_count_color);
+            line.add('/', message_count_color);
 
-        /* Subject */
-        r.set_max_width();
-        r << styled(thread->subject, Color::SearchViewSubject);
+            /* Threads grouped from their matching messages have no total. */
+            if (thread.total_messages > 0)
+                line.add_number(thread.total_messages, message_count_color);
+            else
+                line.add('?', message_count_color);
 
-        /* Tags */
-        r.set_color(Color::SearchViewTags);
-        for (auto & tag : thread->tags)
-        {
-            r.skip(1);
-            r << tag;
-        }
+            line.add(']');
+            line.advance(messageCountWidth);
+
+            /* Authors */
+            line.set_max_width(authorsWidth - 1);
+            line.add(thread.authors, Color::SearchViewAuthors);
+            line.advance(authorsWidth);
+
+            /* Subject */
+            line.set_max_width();
+            line.add(thread.subject, Color::SearchViewSubject);
+
+            /* Tags */
+            for (auto & tag : thread.tags.names())
+            {
+                line.skip(1);
+                line.add(tag, Color::SearchViewTags);
+            }
 
-        r.add_cut_off_indicator();
+            line.add_cut_off_indicator();
+        });
     }
+
+    _rows.end(row);
 }
 
 std::vector<std::string> SearchView::status() const
@@ -139,16 +198,30 @@ std::vector<std::string> SearchView::status() const
     else
         threadPosition << "no matching threads";
 
-    return std::vector<std::string>{
+    if (_refreshing)
+        threadPosition << " (refreshing)";
+
+    std::vector<std::string> status{
         "search-terms: \"" + _searchTerms + '"',
         threadPosition.str()
     };
+
+    if (_windowed)
+    {
+        char begin[16], end[16];
+        time_t last = std::max(_windowBegin, _windowEnd - 1);
+
+        strftime(begin, sizeof(begin), "%F", localtime(&_windowBegin));
+        strftime(end, sizeof(end), "%F", localtime(&last));
+
+        status.push_back(std::string("dates ") + begin + " to " + end);
+    }
+
+    return status;
 }
 
 void SearchView::openSelectedThread()
 {
-    std::lock_guard<std::mutex> lock(_mutex);
-
     if (_selectedIndex < _threads.size())
     {
         try
@@ -168,67 +241,762 @@ void SearchView::openSelectedThread()
     }
 }
 
+void SearchView::tagSelectedThread()
+{
+    TagOperations ops;
+
+    if (!promptTagOperations(ops, "Tag thread: "))
+        return;
+
+    if (_selectedIndex < _threads.size())
+        _threads.at(_selectedIndex).perform_tag_operations(ops);
+}
+
+void SearchView::tagAllResults()
+{
+    TagOperations ops;
+
+    if (!promptTagOperations(ops, "Tag all: "))
+        return;
+
+    TagQueue::instance().enqueue(_searchTerms, ops);
+
+    /* Only the matching messages of each thread are tagged. Removing a tag
+     * from them leaves it on the thread if other messages have it, so for
+     * threads which only match partially, only the tags certain to be added
+     * are shown right away; the rest shows once the threads are refreshed.
+     * Threads which have not been adopted yet are updated as they are. */
+    TagOperations additions;
+
+    for (auto op = ops.begin(), e = ops.end(); op != e; ++op)
+    {
+        bool undone = std::any_of(op + 1, e, [&op](const TagOperation & later) {
+            return later.type == TagOperation::Clear
+                || (later.type == TagOperation::Remove && later.tag == op->tag);
+        });
+
+        if (op->type == TagOperation::Add && !undone)
+            additions.push_back(*op);
+    }
+
+    auto updateTags = [&](ThreadSummary & thread) {
+        if (thread.matched_messages == thread.total_messages)
+            thread.update_tags(ops);
+        else
+            thread.update_tags(additions);
+    };
+
+    adoptThreads();
+
+    for (auto & thread : _threads)
+        updateTags(thread);
+
+    for (auto & thread : _refreshed)
+        updateTags(thread);
+}
+
+void SearchView::jumpToDate()
+{
+    std::string input;
+
+    if (!windowable())
+    {
+        StatusBar::instance().displayMessage("Results are not sorted by date");
+        return;
+    }
+
+    if (!StatusBar::instance().prompt(input, "Jump to date (YYYY-MM-DD): ", "date")
+        || input.empty())
+    {
+        return;
+    }
+
+    struct tm date = tm();
+    const char * end = strptime(input.c_str(), "%Y-%m-%d", &date);
+
+    if (!end)
+    {
+        /* Allow leaving out the day. */
+        date = tm();
+        end = strptime(input.c_str(), "%Y-%m", &date);
+        date.tm_mday = 1;
+    }
+
+    if (!end || *end)
+    {
+        StatusBar::instance().displayMessage("Invalid date: " + input);
+        return;
+    }
+
+    date.tm_isdst = -1;
+    loadWindow(mktime(&date));
+    makeSelectionVisible();
+}
+
+void SearchView::next()
+{
+    LineBrowserView::next();
+    fillWindow();
+}
+
+void SearchView::previous()
+{
+    LineBrowserView::previous();
+    fillWindow();
+}
+
+void SearchView::nextPage()
+{
+    LineBrowserView::nextPage();
+    fillWindow();
+}
+
+void SearchView::previousPage()
+{
+    LineBrowserView::previousPage();
+    fillWindow();
+}
+
+void SearchView::moveToTop()
+{
+    /* Load the first threads, rather than scrolling through the ones in
+     * between. */
+    if (_windowed)
+    {
+        loadWindow(NerConfig::instance().sort_mode == SortMode::NewestFirst
+            ? std::numeric_limits<time_t>::max() : 0);
+    }
+
+    LineBrowserView::moveToTop();
+}
+
+void SearchView::moveToBottom()
+{
+    /* With a count, the line is counted from the top. */
+    if (InputHandler::count(0) > 0)
+    {
+        moveToTop();
+        return;
+    }
+
+    /* Rather than waiting for every thread to be collected, only load the
+     * last ones. */
+    if (windowable() && (_windowed || _collecting))
+    {
+        loadWindow(NerConfig::instance().sort_mode == SortMode::NewestFirst
+            ? 0 : std::numeric_limits<time_t>::max());
+    }
+
+    LineBrowserView::moveToBottom();
+}
+
 void SearchView::refreshThreads()
 {
-    /* If the thread is still going, stop it, and wait for it to return */
-    if (_thread.joinable())
+    /* Load the threads around the selected one again. */
+    if (_windowed)
     {
-        _collecting = false;
-        _thread.join();
+        std::string selectedId;
+        time_t date = _windowBegin;
+
+        if (_selectedIndex < _threads.size())
+        {
+            auto & thread = _threads.at(_selectedIndex);
+
+            selectedId = thread.id;
+            date = std::chrono::system_clock::to_time_t(
+                NerConfig::instance().sort_mode == SortMode::NewestFirst
+                ? thread.date : thread.oldest_date);
+        }
+
+        loadWindow(date);
+        _reselectId = selectedId;
+
+        return;
+    }
+
+    /* Once the results are complete, only the threads which changed since
+     * need to be looked at. */
+    if (!_collecting)
+    {
+        if (_thread.joinable())
+            _thread.join();
+
+        adoptThreads();
+
+        if (!_uuid.empty() && updateThreads())
+        {
+            makeSelectionVisible();
+            return;
+        }
+    }
+
+    stopCollecting();
+
+    /* Keep showing the current results until enough of the new ones are
+     * collected. */
+    _refreshing = !_threads.empty();
+
+    if (_refreshing)
+        _previousPool = std::move(_pool);
+
+    _pool.reset(new StringPool);
+    _uuid.clear();
+
+    /* Start collecting threads in the background */
+    updateCollectLimit();
+
+    _collecting = true;
+    _thread = std::thread(std::bind(&SearchView::collectThreads, this));
+
+    Frame::instance().invalidateStatus();
+}
+
+bool SearchView::updateThreads()
+{
+    auto database = DatabasePool::instance().reader();
+    std::string uuid;
+    unsigned long revision = database->revision(uuid);
+
+    if (uuid != _uuid)
+        return false;
+
+    if (revision == _revision)
+        return true;
+
+    std::ostringstream changedTerms;
+    changedTerms << "lastmod:" << (_revision + 1) << ".." << revision;
+    auto changed = Query(changedTerms.str(), database.get()).thread_ids();
+
+    if (changed.size() > maximumChangedThreads)
+        return false;
+
+    /* Find out which of the changed threads still match. */
+    std::vector<ThreadSummary> matching;
+
+    if (!changed.empty())
+    {
+        std::string terms = "(" + _searchTerms + ") and (";
+
+        for (auto id = changed.begin(), e = changed.end(); id != e; ++id)
+        {
+            if (id != changed.begin())
+                terms += " or ";
+
+            terms += "thread:" + *id;
+        }
+
+        terms += ')';
+
+        Query query(terms, database.get());
+
+        for (const auto & thread : query.thread_summaries(*_pool))
+            matching.push_back(thread);
     }
 
-    bool empty = _threads.empty();
     std::string selectedId;
 
-    if (!empty)
+    if (_selectedIndex < _threads.size())
         selectedId = _threads.at(_selectedIndex).id;
 
+    /* Take out the changed threads, remembering where they were. */
+    std::set<std::string> changedIds(changed.begin(), changed.end());
+    std::map<std::string, size_t> previousIndices;
+    size_t kept = 0;
+
+    for (size_t index = 0; index < _threads.size(); ++index)
+    {
+        if (changedIds.count(_threads[index].id))
+            previousIndices[_threads[index].id] = kept;
+        else
+            _threads[kept++] = _threads[index];
+    }
+
+    _threads.resize(kept);
+
+    for (auto & thread : matching)
+    {
+        auto previous = previousIndices.find(thread.id);
+        insertThread(thread, previous == previousIndices.end()
+            ? _threads.size() : previous->second);
+    }
+
+    /* Keep the same thread selected, if it still matches. */
+    auto selected = std::find_if(_threads.begin(), _threads.end(),
+        [&selectedId](const ThreadSummary & thread) { return thread.id == selectedId; });
+
+    if (selected != _threads.end())
+        _selectedIndex = selected - _threads.begin();
+    else if (_selectedIndex >= _threads.size())
+        _selectedIndex = _threads.empty() ? 0 : _threads.size() - 1;
+
+    _revision = revision;
+
+    return true;
+}
+
+void SearchView::insertThread(const ThreadSummary & thread, size_t previousIndex)
+{
+    std::vector<ThreadSummary>::iterator position;
+
+    switch (NerConfig::instance().sort_mode)
+    {
+        case SortMode::NewestFirst:
+            position = std::upper_bound(_threads.begin(), _threads.end(), thread,
+                [](const ThreadSummary & a, const ThreadSummary & b) {
+                    return a.date > b.date;
+                });
+            break;
+        case SortMode::OldestFirst:
+            position = std::upper_bound(_threads.begin(), _threads.end(), thread,
+                [](const ThreadSummary & a, const ThreadSummary & b) {
+                    return a.oldest_date < b.oldest_date;
+                });
+            break;
+        default:
+            /* Otherwise, the thread stays where it was. */
+            position = _threads.begin() + std::min(previousIndex, _threads.size());
+            break;
+    }
+
+    _threads.insert(position, thread);
+}
+
+bool SearchView::windowable() const
+{
+    SortMode sort_mode = NerConfig::instance().sort_mode;
+
+    return sort_mode == SortMode::NewestFirst || sort_mode == SortMode::OldestFirst;
+}
+
+void SearchView::loadWindow(time_t date)
+{
+    stopCollecting();
+
     _threads.clear();
+    _rows.clear();
+    _pool.reset(new StringPool);
+    _uuid.clear();
+    _selectedIndex = 0;
+    _offset = 0;
+    _reselectId.clear();
+
+    _windowed = true;
+
+    auto database = DatabasePool::instance().reader();
+    Query query(_searchTerms, database.get());
+
+    if (!query.dates(_oldestDate, _newestDate))
+    {
+        _windowBegin = _windowEnd = _oldestDate = _newestDate = 0;
+        return;
+    }
+
+    /* Make the range include the newest message. */
+    ++_newestDate;
+
+    date = std::min(std::max(date, _oldestDate), _newestDate);
+    _windowBegin = _windowEnd = date;
+
+    /* Start with ranges long enough for a couple of pages, assuming messages
+     * are spread out evenly. */
+    unsigned messages = std::max(query.count_messages(), 1u);
+    _span = std::max<time_t>((_newestDate - _oldestDate) / messages * visibleLines() * 2,
+        minimumSpan);
+
+    /* The threads following the date, in the order of the results, go below
+     * the selection, and those preceding it above, once the ones below are
+     * loaded. */
+    if (!extendWindow(false))
+        extendWindow(true);
+}
+
+bool SearchView::extendWindow(bool top)
+{
+    bool newer = top == (NerConfig::instance().sort_mode == SortMode::NewestFirst);
+
+    if (newer ? _windowEnd >= _newestDate : _windowBegin <= _oldestDate)
+        return false;
+
+    /* The last load is done, but may not have been joined yet. */
+    if (_thread.joinable())
+        _thread.join();
 
-    /* Start collecting threads in the background */
     _collecting = true;
-    _thread = std::thread(std::bind(&SearchView::collectThreads, this));
+    _thread = std::thread(std::bind(&SearchView::loadRanges, this, top,
+        newer ? _windowEnd : _windowBegin, _span, std::max(visibleLines(), 1)));
 
-    /* Locate the previously selected thread ID */
-    bool found = false;
-    std::unique_lock<std::mutex> lock(_mutex);
+    return true;
+}
+
+void SearchView::loadRanges(bool top, time_t edge, time_t span, size_t wanted)
+{
+    bool newer = top == (NerConfig::instance().sort_mode == SortMode::NewestFirst);
+    size_t loaded = 0;
+
+    auto database = DatabasePool::instance().reader();
+
+    while (_collecting && loaded < wanted)
+    {
+        LoadedRange range;
+        range.top = top;
+
+        if (newer)
+        {
+            if (edge >= _newestDate)
+                break;
+
+            range.begin = edge;
+            range.end = edge = std::min(edge + span, _newestDate);
+        }
+        else
+        {
+            if (edge <= _oldestDate)
+                break;
 
-    if (empty)
-        found = true;
+            range.end = edge;
+            range.begin = edge = std::max(edge - span, _oldestDate);
+        }
+
+        Query query(restrict_to_dates(_searchTerms, range.begin, range.end),
+            database.get());
+        query.set_sort_mode(NerConfig::instance().sort_mode);
+
+        for (const auto & thread : query.thread_summaries(*_pool))
+            range.threads.push_back(thread);
+
+        loaded += range.threads.size();
+
+        /* Adjust the length of the ranges to the density of the results. */
+        if (range.threads.size() < wanted)
+            span *= 2;
+        else if (range.threads.size() > 4 * wanted)
+            span = std::max(span / 2, minimumSpan);
+
+        range.span = span;
+
+        /* Each range is shown as soon as it is loaded. */
+        std::vector<LoadedRange> chunk;
+        chunk.push_back(std::move(range));
+        _loaded.push(std::move(chunk));
+        EventLoop::instance().wake();
+    }
+
+    _collecting = false;
+
+    /* The window may need more threads from the other side. */
+    EventLoop::instance().wake();
+}
+
+/* Adds the matches a thread has in another date range to it. */
+static void mergeThread(ThreadSummary & thread, const ThreadSummary & other)
+{
+    /* A range loaded again after the window was trimmed holds messages
+     * which were already counted. */
+    if (other.date < thread.oldest_date || other.oldest_date > thread.date)
+        thread.matched_messages += other.matched_messages;
     else
+        thread.matched_messages = std::max(thread.matched_messages, other.matched_messages);
+
+    thread.date = std::max(thread.date, other.date);
+    thread.oldest_date = std::min(thread.oldest_date, other.oldest_date);
+}
+
+void SearchView::adoptRange(const LoadedRange & range)
+{
+    _windowBegin = std::min(_windowBegin, range.begin);
+    _windowEnd = std::max(_windowEnd, range.end);
+    _span = range.span;
+
+    bool newer = range.top == (NerConfig::instance().sort_mode == SortMode::NewestFirst);
+    std::string selectedId = _reselectId;
+
+    /* A thread selected before the window was loaded again has its newest
+     * (or oldest) message at the date it was loaded around, so it can only
+     * be in the first newer range. */
+    if (newer)
+        _reselectId.clear();
+
+    if (range.threads.empty())
+        return;
+
+    if (selectedId.empty() && _selectedIndex < _threads.size())
+        selectedId = _threads.at(_selectedIndex).id;
+
+    bool first = _threads.empty();
+    std::vector<ThreadSummary> threads(range.threads);
+
+    if (range.top)
+        threads.insert(threads.end(), _threads.begin(), _threads.end());
+    else
+        threads.insert(threads.begin(), _threads.begin(), _threads.end());
+
+    /* A thread with messages in several ranges belongs where it shows up
+     * first, since threads are sorted by their newest (or oldest) message,
+     * and the matches of the others are added to it. */
+    std::unordered_map<std::string, size_t> indices;
+    _threads.clear();
+
+    for (auto & thread : threads)
     {
-        int index = 0;
+        auto entry = indices.find(thread.id);
 
-        while (!found && _collecting)
+        if (entry == indices.end())
         {
-            for (; index < _threads.size(); ++index)
-            {
-                /* Stop if we found the thread ID */
-                if (_threads.at(index).id == selectedId)
-                {
-                    found = true;
-                    _selectedIndex = index;
-                    break;
-                }
-            }
+            indices.insert(std::make_pair(thread.id, _threads.size()));
+            _threads.push_back(thread);
+        }
+        else
+            mergeThread(_threads[entry->second], thread);
+    }
+
+    /* Keep the selection on the same thread, and in the same place on the
+     * screen. */
+    auto selected = indices.find(selectedId);
+
+    if (selected != indices.end())
+    {
+        int index = selected->second;
+
+        _offset = std::max(_offset + index - _selectedIndex, 0);
+        _selectedIndex = index;
+        _reselectId.clear();
+    }
+    else if (first && range.top)
+    {
+        /* There was nothing below the date the window was loaded around. */
+        _selectedIndex = _threads.size() - 1;
+    }
+
+    trimWindow(range.top);
+}
+
+void SearchView::fillWindow()
+{
+    /* Let the collection continue if it was waiting for the selection to
+     * move on. */
+    updateCollectLimit();
+
+    if (!_windowed || _collecting)
+        return;
+
+    /* The threads of the last load have to be in the window before the
+     * next one starts from its edge. */
+    if (adoptThreads())
+        makeSelectionVisible();
+
+    if (_selectedIndex < visibleLines() && extendWindow(true))
+        return;
+
+    if (_selectedIndex + visibleLines() >= _threads.size())
+        extendWindow(false);
+}
+
+void SearchView::stopCollecting()
+{
+    /* If the thread is still going, stop it, and wait for it to return */
+    if (_thread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _collecting = false;
+        }
+
+        _resume.notify_all();
+        _thread.join();
+
+        /* Drop whatever was collected but not adopted yet. */
+        std::vector<CollectedThread> chunk;
+        while (_collected.pop(chunk));
+
+        std::vector<LoadedRange> ranges;
+        while (_loaded.pop(ranges));
+    }
+
+    /* An unfinished refresh is abandoned, and the current results are kept,
+     * but they can't be updated incrementally anymore. */
+    if (_refreshing)
+    {
+        _refreshed.clear();
+        _refreshedIndices.clear();
+        _pool = std::move(_previousPool);
+        _uuid.clear();
+        _refreshing = false;
+    }
+}
+
+bool SearchView::adoptThreads()
+{
+    /* Once the collector is done, every chunk has been pushed. */
+    bool complete = !_collecting;
+    bool adopted = false;
+    std::vector<CollectedThread> chunk;
+
+    while (_collected.pop(chunk))
+    {
+        auto & threads = _refreshing ? _refreshed : _threads;
 
-            _condition.wait_for(lock, conditionWaitTime);
+        for (auto & collected : chunk)
+        {
+            if (collected.index < threads.size())
+                threads[collected.index] = collected.thread;
+            else
+                threads.push_back(collected.thread);
+
+            if (_refreshing)
+                _refreshedIndices[collected.thread.id] = collected.index;
         }
+
+        adopted = true;
     }
 
-    /* Wait until we have enough threads to fill the screen */
-    while (_threads.size() - _offset < getmaxy(_window) && _collecting)
-        _condition.wait_for(lock, conditionWaitTime);
+    std::vector<LoadedRange> ranges;
 
-    /* If we didn't find it, make sure the selected index is valid */
-    if (!found)
+    while (_loaded.pop(ranges))
     {
-        if (_threads.size() <= _selectedIndex)
-            _selectedIndex = _threads.size() - 1;
+        for (auto & range : ranges)
+            adoptRange(range);
+
+        adopted = true;
     }
 
-    StatusBar::instance().update();
-    makeSelectionVisible();
+    if (_refreshing)
+        return swapRefreshed(complete);
+
+    return adopted;
+}
+
+bool SearchView::swapRefreshed(bool complete)
+{
+    std::string selectedId;
+
+    if (_selectedIndex < _threads.size())
+        selectedId = _threads.at(_selectedIndex).id;
+
+    auto selected = _refreshedIndices.find(selectedId);
+    bool found = selected != _refreshedIndices.end();
+
+    /* The collector waits for the selection to move once it is a whole
+     * search window past it. */
+    bool full = _searchWindow > 0
+        && _refreshed.size() >= _selectedIndex + visibleLines() + _searchWindow;
+
+    if (!complete && !full && !(found && _refreshed.size() >= visibleLines()))
+        return false;
+
+    /* Keep the selection on the same line of the screen. */
+    int row = _selectedIndex - _offset;
+
+    if (found)
+        _selectedIndex = selected->second;
+    else if (_selectedIndex >= _refreshed.size())
+        _selectedIndex = _refreshed.empty() ? 0 : _refreshed.size() - 1;
+
+    _offset = std::max(_selectedIndex - row, 0);
+
+    _threads.swap(_refreshed);
+    _refreshed.clear();
+    _refreshedIndices.clear();
+    _rows.clear();
+
+    /* Nothing refers to the strings of the old results anymore. */
+    _previousPool.reset();
+    _refreshing = false;
+
+    return true;
+}
+
+bool SearchView::waitForRoom(size_t collected)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    _resume.wait(lock, [this, collected]() {
+        return !_collecting || collected < _collectLimit;
+    });
+
+    return _collecting;
+}
+
+void SearchView::updateCollectLimit()
+{
+    size_t lines = std::max(visibleLines(), 0);
+    size_t limit = _searchWindow == 0 ? std::numeric_limits<size_t>::max()
+        : _selectedIndex + lines + _searchWindow;
+
+    _screenLines = lines;
+
+    if (limit == _collectLimit)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _collectLimit = limit;
+    }
+
+    _resume.notify_all();
+}
+
+void SearchView::trimWindow(bool top)
+{
+    if (_searchWindow == 0)
+        return;
+
+    bool newestFirst = NerConfig::instance().sort_mode == SortMode::NewestFirst;
+    auto key = [newestFirst](const ThreadSummary & thread) {
+        return std::chrono::system_clock::to_time_t(newestFirst ? thread.date
+            : thread.oldest_date);
+    };
+
+    /* Threads were added at the top, so drop some from the bottom. Threads
+     * with the same date as the last one kept are loaded again when the
+     * window reaches them, and are then merged into the kept ones. */
+    if (top)
+    {
+        size_t keep = _selectedIndex + visibleLines() + _searchWindow;
+
+        if (_threads.size() <= keep)
+            return;
+
+        time_t last = key(_threads.at(keep - 1));
+        _threads.resize(keep);
+
+        if (newestFirst)
+            _windowBegin = last + 1;
+        else
+            _windowEnd = last;
+    }
+    else
+    {
+        if (_selectedIndex <= _searchWindow)
+            return;
+
+        size_t drop = _selectedIndex - _searchWindow;
+        time_t first = key(_threads.at(drop));
+
+        _threads.erase(_threads.begin(), _threads.begin() + drop);
+        _selectedIndex -= drop;
+        _offset = std::max<int>(_offset - drop, 0);
+
+        if (newestFirst)
+            _windowEnd = first;
+        else
+            _windowBegin = first + 1;
+    }
+}
+
+SearchView::RowKey::RowKey(const ThreadSummary & thread, bool selected)
+    : id(thread.id), subject(thread.subject), authors(thread.authors),
+        tags(thread.tags), date(thread.date),
+        matched_messages(thread.matched_messages), total_messages(thread.total_messages),
+        selected(selected)
+{
+}
+
+bool SearchView::RowKey::operator==(const RowKey & other) const
+{
+    return id == other.id && subject == other.subject && authors == other.authors
+        && tags == other.tags && date == other.date
+        && matched_messages == other.matched_messages
+        && total_messages == other.total_messages && selected == other.selected;
 }
 
 int SearchView::lineCount() const
@@ -238,33 +1006,96 @@ int SearchView::lineCount() const
 
 void SearchView::collectThreads()
 {
-    Database database;
-    Query query(_searchTerms, &database);
+    auto database = DatabasePool::instance().reader();
+    Query query(_searchTerms, database.get());
+
+    /* Anything that changes after this will be picked up by the next
+     * refresh. */
+    std::string uuid;
+    unsigned long revision = database->revision(uuid);
 
     query.set_sort_mode(NerConfig::instance().sort_mode);
 
-    std::unique_lock<std::mutex> lock(_mutex);
-    lock.unlock();
+    std::vector<CollectedThread> chunk;
+    size_t collected = 0;
+    auto published = std::chrono::steady_clock::now();
 
-    for (const auto & thread : query.threads())
-    {
+    auto publish = [&]() {
+        if (!chunk.empty())
+        {
+            _collected.push(std::move(chunk));
+            chunk.clear();
+            published = std::chrono::steady_clock::now();
+            EventLoop::instance().wake();
+        }
+    };
+
+    auto collect = [&](size_t index, const ThreadSummary & thread, bool added) {
         if (!_collecting)
-            break;
+            return false;
+
+        if (added)
+        {
+            /* Only take the lock once the window is full, and don't keep
+             * threads back while waiting for the selection to move. */
+            if (collected >= _collectLimit)
+            {
+                publish();
 
-        lock.lock();
+                if (!waitForRoom(collected))
+                    return false;
+            }
+
+            ++collected;
+        }
 
-        _threads.push_back(thread);
-        _condition.notify_one();
+        chunk.push_back({ index, thread });
 
-        lock.unlock();
+        /* The first screen is shown as soon as possible, and the rest in
+         * chunks. */
+        if (collected <= _screenLines || chunk.size() >= chunkSize
+            || std::chrono::steady_clock::now() - published >= publishInterval)
+        {
+            publish();
+        }
 
-        sched_yield();
+        return true;
+    };
+
+    if (_engine == ThreadEngine::Messages)
+    {
+        ThreadGrouper grouper(*_pool);
+
+        grouper.group(query, [&](size_t index, bool added) {
+            return collect(index, grouper.summary(index), added);
+        });
+    }
+    else
+    {
+        /* Large results are searched in several date ranges at once. */
+        unsigned slices = std::min(std::max(std::thread::hardware_concurrency(), 1u),
+            maximumSlices);
+        ShardedQuery sharded_query(_searchTerms, NerConfig::instance().sort_mode,
+            *_pool, slices);
+
+        sharded_query.run([&](size_t index, bool added) {
+            return collect(index, sharded_query.summary(index), added);
+        });
+    }
+
+    publish();
+
+    /* These are only read once the collector is done. */
+    if (_collecting)
+    {
+        _uuid = uuid;
+        _revision = revision;
     }
 
     _collecting = false;
 
-    /* For cases when there are no matching threads */
-    _condition.notify_one();
+    /* A refresh may be waiting for the results to be complete. */
+    EventLoop::instance().wake();
 }
 
 // vim: fdm=syntax fo=croql et sw=4 sts=4 ts=8
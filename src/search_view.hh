@@ -21,17 +21,27 @@
 #define NER_SEARCH_VIEW 1
 
 #include <string>
+#include <memory>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
+#include <atomic>
+#include <unordered_map>
+#include <ctime>
 
 #include "line_browser_view.hh"
-#include "notmuch/thread.hh"
+#include "chunk_queue.hh"
+#include "row_cache.hh"
+#include "relative_time.hh"
+#include "notmuch/thread_summary.hh"
+#include "notmuch/string_pool.hh"
+#include "notmuch/thread_grouper.hh"
 
 class SearchView : public LineBrowserView
 {
     public:
         SearchView(const std::string & search,
+            Notmuch::ThreadEngine engine = Notmuch::ThreadEngine::Threads,
             const View::Geometry & geometry = View::Geometry());
         virtual ~SearchView();
 
@@ -42,20 +52,214 @@ class SearchView : public LineBrowserView
         void openSelectedThread();
         void refreshThreads();
 
+        void tagSelectedThread();
+        void tagAllResults();
+
+        /**
+         * Prompts for a date, and loads the threads around it.
+         */
+        void jumpToDate();
+
+        virtual void next();
+        virtual void previous();
+        virtual void nextPage();
+        virtual void previousPage();
+        virtual void moveToTop();
+        virtual void moveToBottom();
+
     protected:
         virtual int lineCount() const;
 
     private:
+        static const KeyMap & keyMap();
+
+        /* A thread found by the collector, to be put at the given index. */
+        struct CollectedThread
+        {
+            size_t index;
+            Notmuch::ThreadSummary thread;
+        };
+
+        /* The threads of a date range loaded past the top or bottom of the
+         * results, and the length of the next range. */
+        struct LoadedRange
+        {
+            bool top;
+            time_t begin;
+            time_t end;
+            time_t span;
+            std::vector<Notmuch::ThreadSummary> threads;
+        };
+
+        /* What a line of the results shows. The strings are compared by
+         * address, so the rows are cleared whenever the string pool is. */
+        struct RowKey
+        {
+            RowKey() = default;
+            RowKey(const Notmuch::ThreadSummary & thread, bool selected);
+
+            bool operator==(const RowKey & other) const;
+
+            const char * id;
+            const char * subject;
+            const char * authors;
+            Notmuch::TagSet tags;
+            std::chrono::system_clock::time_point date;
+            uint32_t matched_messages;
+            uint32_t total_messages;
+            bool selected;
+        };
+
         void collectThreads();
+        void stopCollecting();
+
+        /**
+         * Takes the threads the collector has found so far.
+         *
+         * \return Whether the shown results changed.
+         */
+        bool adoptThreads();
+
+        /**
+         * Shows the refreshed results in place of the current ones, once
+         * there are enough of them to keep the selected thread selected.
+         *
+         * \param complete Whether every refreshed thread has been adopted.
+         * \return Whether the results were swapped.
+         */
+        bool swapRefreshed(bool complete);
+
+        /**
+         * Whether the results can be loaded a date range at a time, which
+         * depends on the sort order.
+         */
+        bool windowable() const;
+
+        /**
+         * Replaces the results with the threads around the given date.
+         */
+        void loadWindow(time_t date);
+
+        /**
+         * Starts loading at least a page of threads past the top or bottom
+         * of the loaded results in the background. Only one load runs at a
+         * time.
+         *
+         * \return Whether there were more threads to load.
+         */
+        bool extendWindow(bool top);
+
+        /**
+         * Loads date ranges from the given edge of the window until enough
+         * threads are found, or there are no more. Runs in the background,
+         * and never looks at the window itself.
+         */
+        void loadRanges(bool top, time_t edge, time_t span, size_t wanted);
+
+        /**
+         * Adds the threads of a loaded range to the results, merging those
+         * which were already loaded from another range.
+         */
+        void adoptRange(const LoadedRange & range);
+
+        /**
+         * Loads more threads if the selection is near the edge of the
+         * loaded results.
+         */
+        void fillWindow();
+
+        /**
+         * Drops the threads that are further than the search window from
+         * the selection, on the opposite side of the given one.
+         */
+        void trimWindow(bool top);
+
+        /**
+         * Waits until the collected threads are no longer a whole search
+         * window ahead of the selection.
+         *
+         * \return Whether to keep collecting.
+         */
+        bool waitForRoom(size_t collected);
+
+        /**
+         * Updates how many threads the collector may collect before it
+         * waits, from the selection and the size of the screen, and lets
+         * it go on if that grew. The collector never looks at the selection
+         * or the window itself.
+         */
+        void updateCollectLimit();
+
+        /**
+         * Updates the threads which changed since the results were
+         * collected.
+         *
+         * \return Whether the results could be updated, rather than having
+         *         to be collected again.
+         */
+        bool updateThreads();
+        void insertThread(const Notmuch::ThreadSummary & thread, size_t previousIndex);
 
         std::string _searchTerms;
+        Notmuch::ThreadEngine _engine;
 
         std::thread _thread;
         std::mutex _mutex;
-        std::condition_variable _condition;
-        bool _collecting;
+        std::condition_variable _resume;
+        std::atomic<bool> _collecting;
+
+        /* The number of threads to keep loaded beyond the screen, or 0 to
+         * load every thread. */
+        unsigned _searchWindow;
+
+        /* How many threads the collector may collect before it waits. It is
+         * only changed with _mutex held, so that the collector doesn't miss
+         * the notification. */
+        std::atomic<size_t> _collectLimit;
+
+        /* The number of threads on a screen, which the collector publishes
+         * as soon as it finds them. */
+        std::atomic<size_t> _screenLines;
+
+        /* Only used by the UI thread. */
+        std::vector<Notmuch::ThreadSummary> _threads;
+
+        ChunkQueue<CollectedThread> _collected;
+        ChunkQueue<LoadedRange> _loaded;
+        std::unique_ptr<Notmuch::StringPool> _pool;
+
+        /* While refreshing, the current results stay shown, and the threads
+         * collected again are kept aside, along with where each of them
+         * is. */
+        bool _refreshing;
+        std::vector<Notmuch::ThreadSummary> _refreshed;
+        std::unordered_map<std::string, size_t> _refreshedIndices;
+        std::unique_ptr<Notmuch::StringPool> _previousPool;
+
+        /* The database the results were collected from, and its revision at
+         * the time. */
+        std::string _uuid;
+        unsigned long _revision;
+
+        /* When only the threads of a date range are loaded, the range, as well
+         * as the range of all matching messages. The ends are exclusive. The
+         * latter is also read while loading ranges, and only changes once
+         * that is stopped. */
+        bool _windowed;
+        time_t _windowBegin;
+        time_t _windowEnd;
+        time_t _oldestDate;
+        time_t _newestDate;
+
+        /* After the window was loaded again, the thread to select once it
+         * shows up. */
+        std::string _reselectId;
+
+        /* The length of the date ranges loaded at a time. */
+        time_t _span;
 
-        std::vector<Notmuch::Thread> _threads;
+        RowCache<RowKey> _rows;
+        RelativeTime _relativeTime;
 };
 
 #endif
@@ -23,15 +23,21 @@
 #include "view.hh"
 #include "view_manager.hh"
 #include "line_editor.hh"
+#include "event_loop.hh"
+#include "frame.hh"
 #include "util.hh"
-#include <unistd.h>
+
+#include "notmuch/tag_queue.hh"
+
+/* How long messages are shown for. */
+const auto messageDuration = std::chrono::milliseconds(1500);
 
 StatusBar * StatusBar::_instance = 0;
 
 StatusBar::StatusBar()
     : _statusWindow(newwin(1, COLS, LINES - 2, 0)),
         _promptWindow(newwin(1, COLS, LINES - 1, 0)),
-        _messageCleared(true)
+        _messageCleared(true), _messageTimer(0)
 {
     _instance = this;
 
@@ -45,8 +51,8 @@ StatusBar::~StatusBar()
 {
     _instance = 0;
 
-    if (_messageClearThread.joinable())
-        _messageClearThread.join();
+    if (!_messageCleared)
+        EventLoop::instance().cancelTimer(_messageTimer);
 }
 
 void StatusBar::update()
@@ -60,8 +66,20 @@ void StatusBar::update()
     /* View Name */
     r << enable_attr(A_BOLD) << '[' << view.name() << ']' << clear_attr;
 
+    std::vector<std::string> statuses(view.status());
+
+    /* Pending writes */
+    unsigned pending = Notmuch::TagQueue::instance().pending();
+    unsigned failed = Notmuch::TagQueue::instance().failed();
+
+    if (pending > 0)
+        statuses.push_back(std::to_string(pending) + " pending writes");
+
+    if (failed > 0)
+        statuses.push_back(std::to_string(failed) + " failed writes");
+
     /* Status */
-    for (auto & status : view.status())
+    for (auto & status : statuses)
     {
         r.skip(1);
         r << styled('|', Color::StatusBarStatusDivider, A_BOLD);
@@ -73,8 +91,8 @@ void StatusBar::update()
 
 void StatusBar::refresh()
 {
-    wrefresh(_statusWindow);
-    wrefresh(_promptWindow);
+    wnoutrefresh(_statusWindow);
+    wnoutrefresh(_promptWindow);
 }
 
 void StatusBar::resize()
@@ -96,14 +114,15 @@ void StatusBar::displayMessage(const std::string & message)
     waddstr(_promptWindow, message.c_str());
     wattroff(_promptWindow, A_BOLD);
 
-    wrefresh(_promptWindow);
-
-    _messageCleared = false;
+    Frame::instance().invalidateStatus();
 
-    if (_messageClearThread.joinable())
-        _messageClearThread.detach();
+    /* Only the latest message needs to be cleared. */
+    if (!_messageCleared)
+        EventLoop::instance().cancelTimer(_messageTimer);
 
-    _messageClearThread = std::thread(std::bind(&StatusBar::delayedClearMessage, this, 1500));
+    _messageCleared = false;
+    _messageTimer = EventLoop::instance().addTimer(messageDuration,
+        std::bind(&StatusBar::clearMessage, this));
 }
 
 bool StatusBar::prompt(std::string & result, const std::string & message,
@@ -124,26 +143,18 @@ bool StatusBar::prompt(std::string & result, const std::string & message,
 
     /* Clear the prompt window after we're done */
     werase(_promptWindow);
-    wrefresh(_promptWindow);
+    Frame::instance().invalidateStatus();
 
     return status;
 }
 
-void StatusBar::delayedClearMessage(int delay)
-{
-    usleep(delay * 1000);
-
-    if (_messageCleared)
-        return;
-
-    clearMessage();
-}
-
 void StatusBar::clearMessage()
 {
+    EventLoop::instance().cancelTimer(_messageTimer);
+
     werase(_promptWindow);
     wbkgd(_promptWindow, COLOR_PAIR(Color::StatusBarPrompt));
-    wrefresh(_promptWindow);
+    Frame::instance().invalidateStatus();
     _messageCleared = true;
 }
 
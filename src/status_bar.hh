@@ -22,9 +22,9 @@
 
 #include <string>
 #include <vector>
-#include <thread>
 
 #include "ncurses.hh"
+#include "timer_wheel.hh"
 
 class StatusBar
 {
@@ -40,6 +40,10 @@ class StatusBar
         int height() const { return 2; }
 
         void update();
+
+        /**
+         * Stages the status bar for the next frame, using wnoutrefresh.
+         */
         void refresh();
         void resize();
 
@@ -51,14 +55,13 @@ class StatusBar
     private:
         static StatusBar * _instance;
 
-        void delayedClearMessage(int delay);
         void clearMessage();
 
         WINDOW * _statusWindow;
         WINDOW * _promptWindow;
 
         bool _messageCleared;
-        std::thread _messageClearThread;
+        TimerWheel::Id _messageTimer;
 };
 
 #endif
@@ -18,6 +18,7 @@
  */
 
 #include "thread_message_view.hh"
+#include "key_map.hh"
 #include "colors.hh"
 
 const int threadViewHeight = 8;
@@ -29,29 +30,43 @@ ThreadMessageView::ThreadMessageView(const View::Geometry & geometry)
             geometry.width, geometry.height - threadViewHeight - 1
         })
 {
-    /* Key Sequences */
-    addHandledSequence("j",          std::bind(&MessageView::next, &_messageView));
-    addHandledSequence("<Down>",     std::bind(&MessageView::next, &_messageView));
-    addHandledSequence("k",          std::bind(&MessageView::previous, &_messageView));
-    addHandledSequence("<Up>",       std::bind(&MessageView::previous, &_messageView));
-
-    addHandledSequence("<PageDown>", std::bind(&MessageView::nextPage, &_messageView));
-    addHandledSequence("<C-d>",      std::bind(&MessageView::nextPage, &_messageView));
-    addHandledSequence("<PageUp>",   std::bind(&MessageView::previousPage, &_messageView));
-    addHandledSequence("<C-u>",      std::bind(&MessageView::previousPage, &_messageView));
-
-    addHandledSequence("gg",         std::bind(&MessageView::moveToTop, &_messageView));
-    addHandledSequence("<Home>",     std::bind(&MessageView::moveToTop, &_messageView));
-    addHandledSequence("G",          std::bind(&MessageView::moveToBottom, &_messageView));
-    addHandledSequence("<End>",      std::bind(&MessageView::moveToBottom, &_messageView));
-    addHandledSequence("<C-s>",      std::bind(&MessageView::saveSelectedPart, &_messageView));
-    addHandledSequence("f",          std::bind(&MessageView::toggleSelectedPartFolding, &_messageView));
-
-    addHandledSequence("r",          std::bind(&ThreadView::reply, &_threadView));
-
-    addHandledSequence(" ",          std::bind(&ThreadMessageView::nextMessage, this));
-    addHandledSequence("<C-n>",      std::bind(&ThreadMessageView::nextMessage, this));
-    addHandledSequence("<C-p>",      std::bind(&ThreadMessageView::previousMessage, this));
+    setKeyMap(keyMap());
+}
+
+const KeyMap & ThreadMessageView::keyMap()
+{
+    auto message = &ThreadMessageView::_messageView;
+
+    static const KeyMap keyMap("thread_message_view", {
+        { "next",               { "j", "<Down>" },
+            KeyMap::bind(message, &MessageView::next) },
+        { "previous",           { "k", "<Up>" },
+            KeyMap::bind(message, &MessageView::previous) },
+
+        { "next_page",          { "<PageDown>", "<C-d>" },
+            KeyMap::bind(message, &MessageView::nextPage) },
+        { "previous_page",      { "<PageUp>", "<C-u>" },
+            KeyMap::bind(message, &MessageView::previousPage) },
+
+        { "top",                { "gg", "<Home>" },
+            KeyMap::bind(message, &MessageView::moveToTop) },
+        { "bottom",             { "G", "<End>" },
+            KeyMap::bind(message, &MessageView::moveToBottom) },
+        { "save_part",          { "<C-s>" },
+            KeyMap::bind(message, &MessageView::saveSelectedPart) },
+        { "toggle_folding",     { "f" },
+            KeyMap::bind(message, &MessageView::toggleSelectedPartFolding) },
+
+        { "reply",              { "r" },
+            KeyMap::bind(&ThreadMessageView::_threadView, &ThreadView::reply) },
+
+        { "next_message",       { " ", "<C-n>" },
+            KeyMap::bind(&ThreadMessageView::nextMessage) },
+        { "previous_message",   { "<C-p>" },
+            KeyMap::bind(&ThreadMessageView::previousMessage) },
+    });
+
+    return keyMap;
 }
 
 ThreadMessageView::~ThreadMessageView()
@@ -68,10 +83,22 @@ void ThreadMessageView::update()
 
 void ThreadMessageView::refresh()
 {
+    /* The divider is drawn on stdscr, which is beneath the other windows. */
+    wnoutrefresh(stdscr);
+
     _threadView.refresh();
     _messageView.refresh();
 }
 
+void ThreadMessageView::focus()
+{
+    View::focus();
+
+    touchwin(stdscr);
+    _threadView.focus();
+    _messageView.focus();
+}
+
 void ThreadMessageView::resize(const View::Geometry & geometry)
 {
     _threadView.resize({ geometry.x, geometry.y, geometry.width, threadViewHeight });
@@ -103,7 +130,12 @@ void ThreadMessageView::previousMessage()
 
 void ThreadMessageView::loadSelectedMessage()
 {
-    _messageView.setMessage(_threadView.selectedMessage().id);
+    Notmuch::Message & message = _threadView.selectedMessage();
+
+    _messageView.setMessage(message.id);
+
+    if (message.tags.contains(Notmuch::TagDictionary::instance().unread()))
+        message.perform_tag_operations({ Notmuch::remove_operation("unread") });
 }
 
 std::vector<std::string> ThreadMessageView::status() const
@@ -31,6 +31,7 @@ class ThreadMessageView : public View
 
         virtual void update();
         virtual void refresh();
+        virtual void focus();
         virtual void resize(const View::Geometry & geometry = View::Geometry());
 
         virtual std::string name() const { return "thread-message-view"; }
@@ -45,6 +46,8 @@ class ThreadMessageView : public View
         void loadSelectedMessage();
 
     private:
+        static const KeyMap & keyMap();
+
         ThreadView _threadView;
         MessageView _messageView;
 };
@@ -21,6 +21,7 @@
 #include <iterator>
 
 #include "thread_view.hh"
+#include "key_map.hh"
 #include "util.hh"
 #include "colors.hh"
 #include "ncurses.hh"
@@ -29,7 +30,7 @@
 #include "status_bar.hh"
 #include "reply_view.hh"
 
-#include "notmuch/database.hh"
+#include "notmuch/database_pool.hh"
 #include "notmuch/exception.hh"
 
 using namespace Notmuch;
@@ -37,9 +38,18 @@ using namespace Notmuch;
 ThreadView::ThreadView(const View::Geometry & geometry)
     : LineBrowserView(geometry)
 {
-    /* Key Sequences */
-    addHandledSequence("\n", std::bind(&ThreadView::openSelectedMessage, this));
-    addHandledSequence("r", std::bind(&ThreadView::reply, this));
+    setKeyMap(keyMap());
+}
+
+const KeyMap & ThreadView::keyMap()
+{
+    static const KeyMap keyMap("thread_view", {
+        { "open",    { "\n" },  KeyMap::bind(&ThreadView::openSelectedMessage) },
+        { "reply",   { "r" },   KeyMap::bind(&ThreadView::reply) },
+        { "tag_all", { "*" },   KeyMap::bind(&ThreadView::tagThread) },
+    }, &LineBrowserView::keyMap());
+
+    return keyMap;
 }
 
 ThreadView::~ThreadView()
@@ -50,12 +60,79 @@ void ThreadView::update()
 {
     using namespace NCurses;
 
-    std::string leading;
-    unsigned index = 0;
+    TagId unread_id = TagDictionary::instance().unread();
+
+    time_t now = time(NULL);
+    _relativeTime.setTime(now);
+
+    /* Relative dates change once a minute. */
+    _rows.begin(_window, _offset, now / 60);
+
+    int row = 0;
+
+    /* Only the first line needs to look at its ancestors. Each following
+     * line shares the lines of the previous message's ancestors up to its
+     * own depth. */
+    std::string lines;
+
+    if (_offset < _thread.tree.size())
+        lines = leading(_offset);
+
+    for (unsigned index = _offset; index < _thread.tree.size() && row < visibleLines();
+        ++index, ++row)
+    {
+        auto & node = _thread.tree[index];
+        const Message & message = node.message;
+
+        if (index > _offset)
+        {
+            auto & previous = _thread.tree[index - 1];
+            lines.push_back(previous.last ? ' ' : ACS_VLINE);
+            lines.resize(node.depth);
+        }
+
+        bool selected = index == _selectedIndex;
+
+        _rows.draw(row, RowKey{ index, message.tags, selected }, [&](Line & line) {
+            bool unread = message.tags.contains(unread_id);
+
+            attr_t attributes = 0;
+
+            if (selected)
+                attributes |= A_REVERSE;
+
+            if (unread)
+                attributes |= A_BOLD;
 
-    Renderer r(_window);
+            line.set_line_attributes(attributes);
+
+            /* Draw message line */
+            for (char c : lines)
+                line.add_acs(c, Color::ThreadViewArrow);
+
+            line.add_acs(node.last ? ACS_LLCORNER : ACS_LTEE, Color::ThreadViewArrow);
+            line.add('>', Color::ThreadViewArrow);
+
+            /* Sender */
+            line.skip(1);
+            line.add(message.headers.find("From")->second);
 
-    display_message_tree(r, _thread.tree, leading, index);
+            /* Date */
+            line.skip(1);
+            line.add(_relativeTime.format(message.date), Color::ThreadViewDate);
+
+            /* Tags */
+            for (auto & tag : message.tags.names())
+            {
+                line.skip(1);
+                line.add(tag, Color::ThreadViewTags);
+            }
+
+            line.add_cut_off_indicator();
+        });
+    }
+
+    _rows.end(row);
 }
 
 std::vector<std::string> ThreadView::status() const
@@ -73,16 +150,18 @@ std::vector<std::string> ThreadView::status() const
 
 void ThreadView::set_thread(const std::string & id)
 {
-    Database database;
+    auto database = DatabasePool::instance().reader();
 
-    /* Don't care about thread metadata. */
-    _thread = database.find_thread(id, Thread::TreePart);
+    /* The authors and tags of the thread itself are not displayed. */
+    _thread = database->find_thread(id, Thread::MetadataPart | Thread::TreePart);
+    _rows.clear();
     focus_first_unread();
 }
 
 void ThreadView::set_thread(const Thread & thread)
 {
     _thread = thread;
+    _rows.clear();
     focus_first_unread();
 }
 
@@ -90,10 +169,11 @@ void ThreadView::focus_first_unread()
 {
     _selectedIndex = 0;
     int message_index = 0;
+    TagId unread = TagDictionary::instance().unread();
 
-    for (auto & message : _thread.tree)
+    for (auto & node : _thread.tree)
     {
-        if (message.tags.find("unread") != message.tags.end())
+        if (node.message.tags.contains(unread))
         {
             _selectedIndex = message_index;
             break;
@@ -121,9 +201,12 @@ void ThreadView::openSelectedMessage()
 
 const Message & ThreadView::selectedMessage() const
 {
-    auto message = _thread.tree.cbegin();
-    std::advance(message, _selectedIndex);
-    return *message;
+    return _thread.tree[_selectedIndex].message;
+}
+
+Message & ThreadView::selectedMessage()
+{
+    return _thread.tree[_selectedIndex].message;
 }
 
 void ThreadView::reply()
@@ -138,74 +221,40 @@ void ThreadView::reply()
     }
 }
 
-int ThreadView::lineCount() const
-{
-    return _thread.total_messages;
-}
-
-void ThreadView::display_message_tree(NCurses::Renderer & r,
-    const Tree<Message> & tree, std::string & leading, unsigned & index) const
+void ThreadView::tagThread()
 {
-    using namespace NCurses;
-
-    auto last_node = &tree.children.back();
-
-    for (auto & node : tree.children)
-    {
-        bool last = &node == last_node;
-
-        if (index >= _offset)
-        {
-            if (r.off_screen())
-                break;
-
-            const Message & message = node.value;
-
-            /* Draw message line */
-            bool selected = r.row() + _offset == _selectedIndex;
-            bool unread = message.tags.find("unread") != message.tags.end();
-
-            attr_t attributes = 0;
-
-            if (selected)
-                attributes |= A_REVERSE;
+    TagOperations ops;
 
-            if (unread)
-                attributes |= A_BOLD;
+    if (!promptTagOperations(ops, "Tag thread: "))
+        return;
 
-            r.set_line_attributes(attributes);
-
-            r << set_color(Color::ThreadViewArrow) << acs << leading
-                << chchar(last ? ACS_LLCORNER : ACS_LTEE) << noacs << '>';
+    _thread.perform_tag_operations(ops);
+}
 
-            /* Sender */
-            r.skip(1);
-            r << set_color() << message.headers.find("From")->second;
+bool ThreadView::RowKey::operator==(const RowKey & other) const
+{
+    return index == other.index && tags == other.tags && selected == other.selected;
+}
 
-            /* Date */
-            r.skip(1);
-            r << styled(relative_time(message.date), Color::ThreadViewDate);
+int ThreadView::lineCount() const
+{
+    return _thread.tree.size();
+}
 
-            /* Tags */
-            r.set_color(Color::ThreadViewTags);
-            for (auto & tag : message.tags)
-            {
-                r.skip(1);
-                r << tag;
-            }
+std::string ThreadView::leading(unsigned index) const
+{
+    std::string lines(_thread.tree[index].depth, ' ');
 
-            r.add_cut_off_indicator();
-            r.next_line();
-        }
+    for (uint32_t parent = _thread.tree[index].parent; parent != MessageTree::NoParent;
+        parent = _thread.tree[parent].parent)
+    {
+        auto & node = _thread.tree[parent];
 
-        leading.push_back(last ? ' ' : ACS_VLINE);
-        display_message_tree(r, node.branch, leading, ++index);
-#if defined __GNUC__ && !__GNUC_PREREQ(4, 7)
-        leading.resize(leading.size() -  1);
-#else
-        leading.pop_back();
-#endif
+        if (!node.last)
+            lines[node.depth] = ACS_VLINE;
     }
+
+    return lines;
 }
 
 // vim: fdm=syntax fo=croql et sw=4 sts=4 ts=8
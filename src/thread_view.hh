@@ -23,6 +23,8 @@
 #include <vector>
 
 #include "line_browser_view.hh"
+#include "row_cache.hh"
+#include "relative_time.hh"
 
 #include "notmuch/thread.hh"
 #include "notmuch/message.hh"
@@ -43,9 +45,11 @@ class ThreadView : public LineBrowserView
         void focus_first_unread();
 
         const Notmuch::Message & selectedMessage() const;
+        Notmuch::Message & selectedMessage();
         virtual void openSelectedMessage();
 
         void reply();
+        void tagThread();
 
     protected:
         virtual int lineCount() const;
@@ -53,11 +57,24 @@ class ThreadView : public LineBrowserView
         std::string _id;
 
     private:
-        void display_message_tree(NCurses::Renderer & r,
-            const Notmuch::Tree<Notmuch::Message> & tree, std::string & leading,
-            unsigned & index) const;
+        static const KeyMap & keyMap();
+
+        /* What a line of the thread shows. Only the tags of a message
+         * change, and the rows are cleared when the thread does. */
+        struct RowKey
+        {
+            unsigned index;
+            Notmuch::TagSet tags;
+            bool selected;
+
+            bool operator==(const RowKey & other) const;
+        };
+
+        std::string leading(unsigned index) const;
 
         Notmuch::Thread _thread;
+        RowCache<RowKey> _rows;
+        RelativeTime _relativeTime;
 };
 
 #endif
@@ -0,0 +1,143 @@
+/* ner: src/timer_wheel.cc
+ *
+ * Copyright (c) 2013 Michael Forney
+ *
+ * This file is a part of ner.
+ *
+ * ner is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License version 3, as published by the Free
+ * Software Foundation.
+ *
+ * ner is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ner.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <algorithm>
+
+#include "timer_wheel.hh"
+
+TimerWheel::TimerWheel(std::chrono::milliseconds tick, unsigned slots)
+    : _tick(tick), _slots(slots), _current(0), _time(Clock::now()), _nextId(1)
+{
+}
+
+TimerWheel::Id TimerWheel::add(std::chrono::milliseconds delay,
+    const std::function<void ()> & callback)
+{
+    /* The wheel may be behind if nobody advanced it for a while. */
+    if (_timers.empty())
+        advance();
+
+    auto elapsed = Clock::now() - _time;
+    auto ticks = std::max<long>(1, (elapsed + delay + _tick
+        - Clock::duration(1)) / _tick);
+
+    size_t slot = (_current + ticks) % _slots.size();
+    Id id = _nextId++;
+
+    _slots[slot].push_back(Timer{ id, unsigned((ticks - 1) / _slots.size()), callback });
+    _timers[id] = slot;
+
+    return id;
+}
+
+bool TimerWheel::cancel(Id id)
+{
+    auto timer = _timers.find(id);
+
+    if (timer == _timers.end())
+        return false;
+
+    auto & slot = _slots[timer->second];
+    auto position = std::find_if(slot.begin(), slot.end(),
+        [id](const Timer & other) { return other.id == id; });
+
+    /* Timers which are about to run have already left their slot. */
+    if (position != slot.end())
+        slot.erase(position);
+
+    _timers.erase(timer);
+
+    return true;
+}
+
+void TimerWheel::advance()
+{
+    auto now = Clock::now();
+
+    /* With no timers, there is nothing to step through. */
+    if (_timers.empty())
+    {
+        auto ticks = (now - _time) / _tick;
+        _current = (_current + ticks) % _slots.size();
+        _time += ticks * _tick;
+        return;
+    }
+
+    while (now - _time >= _tick)
+    {
+        _time += _tick;
+        _current = (_current + 1) % _slots.size();
+
+        auto & slot = _slots[_current];
+        std::vector<Timer> expired;
+
+        for (auto timer = slot.begin(); timer != slot.end();)
+        {
+            if (timer->rounds == 0)
+            {
+                expired.push_back(std::move(*timer));
+                timer = slot.erase(timer);
+            }
+            else
+            {
+                --timer->rounds;
+                ++timer;
+            }
+        }
+
+        /* A callback may cancel another timer which expired at the same
+         * tick, so check each of them is still pending before running it. */
+        for (auto & timer : expired)
+        {
+            if (_timers.erase(timer.id))
+                timer.callback();
+        }
+    }
+}
+
+int TimerWheel::remaining() const
+{
+    if (_timers.empty())
+        return -1;
+
+    /* Find the first slot with a timer expiring in this turn of the wheel.
+     * If there is none, wake up after a whole turn. */
+    size_t ticks = 1;
+
+    for (; ticks < _slots.size(); ++ticks)
+    {
+        auto & slot = _slots[(_current + ticks) % _slots.size()];
+
+        if (std::any_of(slot.begin(), slot.end(),
+            [](const Timer & timer) { return timer.rounds == 0; }))
+        {
+            break;
+        }
+    }
+
+    auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+        _time + ticks * _tick - Clock::now());
+
+    /* Round up, so that the timer has expired once the time is up. */
+    return std::max<int>(remaining.count() + 1, 0);
+}
+
+// vim: fdm=syntax fo=croql et sw=4 sts=4 ts=8
+
@@ -0,0 +1,93 @@
+/* ner: src/timer_wheel.hh
+ *
+ * Copyright (c) 2013 Michael Forney
+ *
+ * This file is a part of ner.
+ *
+ * ner is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License version 3, as published by the Free
+ * Software Foundation.
+ *
+ * ner is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ner.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef NER_TIMER_WHEEL_H
+#define NER_TIMER_WHEEL_H 1
+
+#include <vector>
+#include <unordered_map>
+#include <chrono>
+#include <functional>
+
+/**
+ * Keeps track of timers in a hashed wheel.
+ *
+ * Time advances in ticks, and each timer sits in the slot of the tick it
+ * expires at, along with the number of turns of the wheel left until then.
+ * Adding and cancelling a timer takes constant time, and each tick only
+ * looks at the timers in one slot.
+ */
+class TimerWheel
+{
+    public:
+        typedef unsigned long Id;
+
+        typedef std::chrono::steady_clock Clock;
+
+        TimerWheel(std::chrono::milliseconds tick = std::chrono::milliseconds(10),
+            unsigned slots = 256);
+
+        /**
+         * Adds a timer which runs the callback once the delay has passed.
+         */
+        Id add(std::chrono::milliseconds delay, const std::function<void ()> & callback);
+
+        /**
+         * Cancels a timer, unless it already ran.
+         *
+         * \return Whether the timer was cancelled.
+         */
+        bool cancel(Id id);
+
+        /**
+         * Runs the callbacks of every timer which expired by now.
+         */
+        void advance();
+
+        /**
+         * Returns how many milliseconds are left until the next timer
+         * expires, or -1 if there are none.
+         */
+        int remaining() const;
+
+    private:
+        struct Timer
+        {
+            Id id;
+            unsigned rounds;
+            std::function<void ()> callback;
+        };
+
+        std::chrono::milliseconds _tick;
+        std::vector<std::vector<Timer>> _slots;
+        size_t _current;
+
+        /* When the current tick started. */
+        Clock::time_point _time;
+
+        /* The slot of each pending timer. */
+        std::unordered_map<Id, size_t> _timers;
+        Id _nextId;
+};
+
+#endif
+
+// vim: fdm=syntax fo=croql et sw=4 sts=4 ts=8
+
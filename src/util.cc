@@ -24,47 +24,7 @@
 #include <chrono>
 
 #include "util.hh"
-
-std::string relative_time(const std::chrono::system_clock::time_point & time_point)
-{
-    using namespace std::chrono;
-
-    typedef duration<int, std::ratio<86400>> days;
-
-    auto now = system_clock::now();
-
-    if (time_point > now)
-        return "the future";
-
-    time_t time = system_clock::to_time_t(time_point);
-    time_t current_time = system_clock::to_time_t(now);
-
-    auto difference = now - time_point;
-    struct tm local_time = *std::localtime(&time);
-    struct tm current_local_time = *std::localtime(&current_time);
-
-    /* std::put_time is not available in GCC yet (part of C++11). */
-
-    char string[16];
-
-    if (difference > days(180))
-        strftime(string, sizeof(string), "%F", &local_time);
-    else if (difference < hours(1))
-        snprintf(string, sizeof(string), "%lu mins. ago", duration_cast<minutes>(difference).count());
-    else if (difference < days(7))
-    {
-        if (local_time.tm_wday == current_local_time.tm_wday && difference < days(1))
-            strftime(string, sizeof(string), "Today %R", &local_time);
-        else if ((current_local_time.tm_wday + 7 - local_time.tm_wday) % 7 == 1)
-            strftime(string, sizeof(string), "Yest. %R", &local_time);
-        else
-            strftime(string, sizeof(string), "%a. %R", &local_time);
-    }
-    else
-        strftime(string, sizeof(string), "%B %d", &local_time);
-
-    return string;
-}
+#include "status_bar.hh"
 
 std::string formatByteSize(long size)
 {
@@ -86,5 +46,22 @@ std::string formatByteSize(long size)
     return val.str();
 }
 
+bool promptTagOperations(Notmuch::TagOperations & ops, const std::string & message)
+{
+    std::string operations;
+
+    if (!StatusBar::instance().prompt(operations, message, "tag-operations")
+        || operations.empty())
+        return false;
+
+    if (!Notmuch::parse_tag_operations(operations, ops) || ops.empty())
+    {
+        StatusBar::instance().displayMessage("Invalid tag operations: " + operations);
+        return false;
+    }
+
+    return true;
+}
+
 // vim: fdm=syntax fo=croql et sw=4 sts=4 ts=8
 
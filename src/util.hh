@@ -30,15 +30,22 @@
 #include "ner_config.hh"
 #include "message_part.hh"
 
+#include "notmuch/tag_operations.hh"
+
 constexpr char ctrl(char c)
 {
     return c - 96;
 }
 
-std::string relative_time(const std::chrono::system_clock::time_point & time_point);
-
 std::string formatByteSize(long size);
 
+/**
+ * Prompts the user for a list of tag operations, such as "+flagged -inbox".
+ *
+ * \return Whether a valid, non-empty list of tag operations was entered.
+ */
+bool promptTagOperations(Notmuch::TagOperations & ops, const std::string & message);
+
 template <typename Type>
     struct addressOf : public std::unary_function<Type, Type *>
 {
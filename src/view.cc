@@ -20,6 +20,7 @@
 #include "view.hh"
 #include "status_bar.hh"
 #include "view_manager.hh"
+#include "frame.hh"
 
 View::Geometry::Geometry(int x_, int y_, int width_, int height_)
     : x(x_), y(y_), width(width_), height(height_)
@@ -43,7 +44,7 @@ void View::resize(const Geometry & geometry)
 
 void View::focus()
 {
-    StatusBar::instance().update();
+    Frame::instance().invalidate();
 }
 
 void View::unfocus()
@@ -57,7 +57,7 @@ class View : public InputHandler
         virtual void update() = 0;
 
         /**
-         * Refreshes the screen.
+         * Stages the view's windows for the next frame, using wnoutrefresh.
          */
         virtual void refresh() = 0;
 
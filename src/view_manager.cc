@@ -20,9 +20,11 @@
 #include <algorithm>
 
 #include "view_manager.hh"
+#include "key_map.hh"
 #include "view.hh"
 #include "view_view.hh"
 #include "status_bar.hh"
+#include "frame.hh"
 
 ViewManager * ViewManager::_instance = 0;
 
@@ -30,7 +32,16 @@ ViewManager::ViewManager()
 {
     _instance = this;
 
-    addHandledSequence("q", std::bind(&ViewManager::closeActiveView, this));
+    setKeyMap(keyMap());
+}
+
+const KeyMap & ViewManager::keyMap()
+{
+    static const KeyMap keyMap("view_manager", {
+        { "close", { "q" },  KeyMap::bind(&ViewManager::closeActiveView) },
+    });
+
+    return keyMap;
 }
 
 ViewManager::~ViewManager()
@@ -66,11 +77,7 @@ void ViewManager::addView(const std::shared_ptr<View> & view)
     _activeView = view;
 
     _activeView->focus();
-    _activeView->update();
-    _activeView->refresh();
-
-    StatusBar::instance().update();
-    StatusBar::instance().refresh();
+    Frame::instance().invalidate();
 }
 
 void ViewManager::closeActiveView()
@@ -87,9 +94,7 @@ void ViewManager::closeActiveView()
         _activeView = _views.back();
 
         _activeView->focus();
-
-        StatusBar::instance().update();
-        StatusBar::instance().refresh();
+        Frame::instance().invalidate();
     }
 }
 
@@ -128,13 +133,8 @@ void ViewManager::openView(int index)
 
     _activeView = _views.at(index);
 
-    StatusBar::instance().update();
-    StatusBar::instance().refresh();
-
     _activeView->focus();
-
-    _activeView->update();
-    _activeView->refresh();
+    Frame::instance().invalidate();
 }
 
 void ViewManager::closeView(int index)
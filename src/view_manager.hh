@@ -79,6 +79,8 @@ class ViewManager : public InputHandler
         const View & activeView() const;
 
     private:
+        static const KeyMap & keyMap();
+
         static ViewManager * _instance;
 
         void openView(int index);
@@ -18,6 +18,7 @@
  */
 
 #include "view_view.hh"
+#include "key_map.hh"
 #include "view_manager.hh"
 #include "ncurses.hh"
 
@@ -30,9 +31,17 @@ const int nameWidth = 25;
 ViewView::ViewView(const View::Geometry & geometry)
     : LineBrowserView(geometry)
 {
-    /* Key Sequences */
-    addHandledSequence("\n", std::bind(&ViewView::openSelectedView, this));
-    addHandledSequence("x", std::bind(&ViewView::closeSelectedView, this));
+    setKeyMap(keyMap());
+}
+
+const KeyMap & ViewView::keyMap()
+{
+    static const KeyMap keyMap("view_view", {
+        { "open",  { "\n" },  KeyMap::bind(&ViewView::openSelectedView) },
+        { "close", { "x" },   KeyMap::bind(&ViewView::closeSelectedView) },
+    }, &LineBrowserView::keyMap());
+
+    return keyMap;
 }
 
 ViewView::~ViewView()
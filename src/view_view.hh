@@ -46,6 +46,9 @@ class ViewView : public LineBrowserView
         };
 
         std::vector<ViewInfo> _views;
+
+    private:
+        static const KeyMap & keyMap();
 };
 
 #endif
@@ -34,7 +34,16 @@ WindowView::~WindowView()
 
 void WindowView::refresh()
 {
-    wrefresh(_window);
+    wnoutrefresh(_window);
+}
+
+void WindowView::focus()
+{
+    View::focus();
+
+    /* Another view was shown in the meantime, and views only draw what
+     * changed, so the whole window needs to be shown again. */
+    touchwin(_window);
 }
 
 void WindowView::resize(const View::Geometry & geometry)
@@ -30,6 +30,7 @@ class WindowView : public View
 
         virtual void refresh();
         virtual void resize(const View::Geometry & geometry = View::Geometry());
+        virtual void focus();
 
     protected:
         WINDOW * _window;